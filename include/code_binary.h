@@ -0,0 +1,134 @@
+/**
+ * @name IFJ23
+ * @file code_binary.h
+ * @brief Compact binary container of IFJcode23 instructions
+ * @author Marie Kolarikova <xkolar77@stud.fit.vutbr.cz>
+ * @date 3.12.2023
+ **/
+
+#ifndef CODE_BINARY_H
+#define CODE_BINARY_H
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "code_buffer.h"
+
+/*
+ * Layout of container (numbers are unsigned LEB128 varints):
+ *   magic CODE_BINARY_MAGIC (8 bytes including version)
+ *   count of names,     names:     length, chars, '\0'
+ *   count of constants, constants: type byte, value (zigzag varint, 8 bytes of double, bool byte or string as name)
+ *   count of instructions, instructions: opcode << 1 | blank line, operands: index << 3 | kind
+ * Names (variables without frame, labels, types) and constants are stored once and referenced by index.
+ */
+#define CODE_BINARY_MAGIC "\177IFJc23\001"
+#define CODE_BINARY_MAGIC_LENGTH 8
+
+/**
+ * @brief kind of encoded operand
+ */
+typedef enum {
+    BINARY_CONSTANT, // index of constant
+    BINARY_GLOBAL,   // index of name of variable of global frame
+    BINARY_LOCAL,    // index of name of variable of local frame
+    BINARY_TEMPORARY,// index of name of variable of temporary frame
+    BINARY_LABEL,    // index of name of label
+    BINARY_TYPE      // index of name of type (READ)
+} binary_operand_kind_t;
+
+/**
+ * @brief type of constant of pool
+ */
+typedef enum {
+    BINARY_NIL,
+    BINARY_INT,
+    BINARY_FLOAT,
+    BINARY_BOOL,
+    BINARY_STRING
+} binary_constant_type_t;
+
+/**
+ * @brief decoded constant (string points to data of container)
+ */
+typedef struct binary_constant {
+    binary_constant_type_t type;
+    long long int_val;
+    double float_val;
+    bool bool_val;
+    const char *string_val; // chars without escape sequences ended by '\0'
+    size_t length;
+} binary_constant_t;
+
+/**
+ * @brief decoded operand
+ */
+typedef struct binary_operand {
+    binary_operand_kind_t kind;
+    unsigned index;
+} binary_operand_t;
+
+/**
+ * @brief decoded instruction
+ */
+typedef struct binary_instruction {
+    opcode_t opcode;
+    bool blank_line;
+    binary_operand_t operands[MAX_OPERANDS]; // count of operands is given by instruction_table
+} binary_instruction_t;
+
+/**
+ * @brief opened container (tables point to its data, instructions are decoded one by one)
+ */
+typedef struct code_binary {
+    const unsigned char *data;
+    size_t size;
+    const char **names;
+    unsigned name_count;
+    binary_constant_t *constants;
+    unsigned constant_count;
+    unsigned instruction_count;
+    size_t instructions;        // offset of first instruction
+} code_binary_t;
+
+/**
+ * Writes instructions to container
+ * @param code instructions
+ * @param file output stream
+ * @return false on allocation or output error
+*/
+bool code_binary_write(code_buffer_t *code, FILE *file);
+
+/**
+ * Reads tables of container (container is not copied)
+ * @param binary opened container
+ * @param data content of container
+ * @param size size of content
+ * @return false if container is invalid or on allocation error
+*/
+bool code_binary_open(code_binary_t *binary, const unsigned char *data, size_t size);
+
+/**
+ * Frees tables of container
+ * @param binary opened container
+*/
+void code_binary_close(code_binary_t *binary);
+
+/**
+ * Decodes next instruction
+ * @param binary opened container
+ * @param position offset of instruction (moved to next instruction)
+ * @param instruction decoded instruction
+ * @return false if instruction is invalid
+*/
+bool code_binary_next(code_binary_t *binary, size_t *position, binary_instruction_t *instruction);
+
+/**
+ * Decodes instructions of container to text form
+ * @param binary opened container
+ * @param code empty buffer for instructions
+ * @return false if container is invalid or on allocation error
+*/
+bool code_binary_read(code_binary_t *binary, code_buffer_t *code);
+
+#endif
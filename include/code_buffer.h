@@ -0,0 +1,249 @@
+/**
+ * @name IFJ23
+ * @file code_buffer.h
+ * @brief Buffer of generated IFJcode23 instructions
+ * @author Marie Kolarikova <xkolar77@stud.fit.vutbr.cz>
+ * @date 3.12.2023
+ **/
+
+#ifndef CODE_BUFFER_H
+#define CODE_BUFFER_H
+
+#include <stdio.h>
+#include <stdbool.h>
+#include "dyn_string.h"
+
+#define MAX_OPERANDS 3
+
+/**
+ * @brief opcodes of IFJcode23 instructions
+ */
+typedef enum {
+    OP_MOVE,
+    OP_CREATEFRAME,
+    OP_PUSHFRAME,
+    OP_POPFRAME,
+    OP_DEFVAR,
+    OP_CALL,
+    OP_RETURN,
+    OP_PUSHS,
+    OP_POPS,
+    OP_CLEARS,
+    OP_ADD,
+    OP_SUB,
+    OP_MUL,
+    OP_DIV,
+    OP_IDIV,
+    OP_ADDS,
+    OP_SUBS,
+    OP_MULS,
+    OP_DIVS,
+    OP_IDIVS,
+    OP_LT,
+    OP_GT,
+    OP_EQ,
+    OP_LTS,
+    OP_GTS,
+    OP_EQS,
+    OP_AND,
+    OP_OR,
+    OP_NOT,
+    OP_ANDS,
+    OP_ORS,
+    OP_NOTS,
+    OP_INT2FLOAT,
+    OP_FLOAT2INT,
+    OP_INT2CHAR,
+    OP_STRI2INT,
+    OP_INT2FLOATS,
+    OP_FLOAT2INTS,
+    OP_INT2CHARS,
+    OP_STRI2INTS,
+    OP_READ,
+    OP_WRITE,
+    OP_CONCAT,
+    OP_STRLEN,
+    OP_GETCHAR,
+    OP_SETCHAR,
+    OP_TYPE,
+    OP_LABEL,
+    OP_JUMP,
+    OP_JUMPIFEQ,
+    OP_JUMPIFNEQ,
+    OP_JUMPIFEQS,
+    OP_JUMPIFNEQS,
+    OP_EXIT,
+    OP_BREAK,
+    OP_DPRINT,
+    OP_UNKNOWN
+} opcode_t;
+
+/**
+ * @brief static information about opcode
+ */
+typedef struct instruction_info {
+    const char *name;        // name of instruction in IFJcode23
+    unsigned operand_count;  // count of operands
+    bool writes_target;      // first operand is variable, which is changed by instruction
+} instruction_info_t;
+
+/**
+ * @brief one generated instruction (node of doubly linked list)
+ */
+typedef struct instruction {
+    opcode_t opcode;
+    char *operands[MAX_OPERANDS]; // operands in IFJcode23 notation (GF@x, int@1, label ...)
+    unsigned operand_count;
+    bool blank_line;              // instruction is preceded by empty line in output
+    bool is_constant;             // DEFVAR of immutable variable (let)
+    unsigned line;                // position of statement in source code, which generated instruction (0 if unknown)
+    unsigned column;
+    struct instruction *next;
+    struct instruction *prev;
+} instruction_t;
+
+/**
+ * @brief list of generated instructions
+ */
+typedef struct code_buffer {
+    instruction_t *head;
+    instruction_t *tail;
+} code_buffer_t;
+
+/**
+ * Table of instruction informations indexed by opcode
+ */
+extern const instruction_info_t instruction_table[OP_UNKNOWN];
+
+/**
+ * Initializes empty code buffer
+ * @param buffer buffer to initialize
+*/
+void code_buffer_init(code_buffer_t *buffer);
+
+/**
+ * Frees all instructions of buffer
+ * @param buffer buffer to dispose
+*/
+void code_buffer_dispose(code_buffer_t *buffer);
+
+/**
+ * Creates new instruction
+ * @param opcode opcode of instruction
+ * @param op1 first operand or NULL
+ * @param op2 second operand or NULL
+ * @param op3 third operand or NULL
+ * @return new instruction or NULL on allocation error
+*/
+instruction_t *instruction_create(opcode_t opcode, const char *op1, const char *op2, const char *op3);
+
+/**
+ * Creates instruction from one line of IFJcode23
+ * @param line text of instruction (without new line)
+ * @return new instruction or NULL on allocation error
+*/
+instruction_t *instruction_parse(const char *line);
+
+/**
+ * Creates copy of instruction (not linked to any buffer)
+ * @param instruction copied instruction
+ * @return new instruction or NULL on allocation error
+*/
+instruction_t *instruction_copy(instruction_t *instruction);
+
+/**
+ * Frees instruction, which is not linked to buffer
+ * @param instruction instruction to free
+*/
+void instruction_free(instruction_t *instruction);
+
+/**
+ * Replaces operand of instruction
+ * @param instruction changed instruction
+ * @param index index of operand from 0
+ * @param operand new value of operand
+*/
+void instruction_set_operand(instruction_t *instruction, unsigned index, const char *operand);
+
+/**
+ * Looks up opcode by its name
+ * @param name name of instruction (case insensitive)
+ * @return opcode or OP_UNKNOWN
+*/
+opcode_t instruction_opcode(const char *name);
+
+/**
+ * Appends instruction to the end of buffer
+ * @param buffer target buffer
+ * @param instruction appended instruction
+*/
+void code_buffer_append(code_buffer_t *buffer, instruction_t *instruction);
+
+/**
+ * Moves all instructions of other buffer to the end of buffer
+ * @param buffer target buffer
+ * @param other appended buffer (empty after call)
+*/
+void code_buffer_concat(code_buffer_t *buffer, code_buffer_t *other);
+
+/**
+ * Inserts instruction before position
+ * @param buffer target buffer
+ * @param position instruction in buffer (NULL appends to the end)
+ * @param instruction inserted instruction
+*/
+void code_buffer_insert_before(code_buffer_t *buffer, instruction_t *position, instruction_t *instruction);
+
+/**
+ * Inserts instruction after position
+ * @param buffer target buffer
+ * @param position instruction in buffer (NULL inserts to the beginning)
+ * @param instruction inserted instruction
+*/
+void code_buffer_insert_after(code_buffer_t *buffer, instruction_t *position, instruction_t *instruction);
+
+/**
+ * Unlinks instruction from buffer without freeing it
+ * @param buffer buffer containing instruction
+ * @param instruction unlinked instruction
+*/
+void code_buffer_unlink(code_buffer_t *buffer, instruction_t *instruction);
+
+/**
+ * Removes instruction from buffer and frees it
+ * @param buffer buffer containing instruction
+ * @param instruction removed instruction
+ * @return instruction following the removed one
+*/
+instruction_t *code_buffer_remove(code_buffer_t *buffer, instruction_t *instruction);
+
+/**
+ * Prints instructions of buffer in IFJcode23 text format
+ * @param buffer printed buffer
+ * @param file output stream
+*/
+void code_buffer_print(code_buffer_t *buffer, FILE *file);
+
+/**
+ * Checks if operand is variable (GF@, LF@ or TF@)
+ * @param operand operand of instruction
+ * @return bool
+*/
+bool operand_is_variable(const char *operand);
+
+/**
+ * Checks if operand is constant (int@, float@, string@, bool@ or nil@)
+ * @param operand operand of instruction
+ * @return bool
+*/
+bool operand_is_constant(const char *operand);
+
+/**
+ * Checks if operand is variable of given frame
+ * @param operand operand of instruction
+ * @param frame frame name ("GF", "LF" or "TF")
+ * @return bool
+*/
+bool operand_in_frame(const char *operand, const char *frame);
+
+#endif
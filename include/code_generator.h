@@ -47,6 +47,32 @@ bool code_generator_need_function_frame(char* name);
 */
 void code_generator_prolog();
 
+/**
+ * Sets source position of next generated instructions
+ * @param token first token of generated statement
+*/
+void code_generator_source_position(token_T token);
+
+/**
+ * Enables map of source lines written by code_generator_eof
+ * (line "index line column" for every instruction, index counts instructions of output from 0)
+ * @param path file of map (NULL disables map)
+*/
+void code_generator_line_map(const char* path);
+
+/**
+ * Enables binary container of generated code written by code_generator_eof next to text form
+ * @param path file of container (NULL disables container)
+*/
+void code_generator_binary(const char* path);
+
+/**
+ * Enables compact output (variables get short names by count of their uses, blank lines are not printed)
+ * @param compact compact output is generated
+ * @param names_path file of map of short names to names of variables (NULL if map is not written)
+*/
+void code_generator_compact(bool compact, const char* names_path);
+
 /**
  * Creates header of if
  * @pre On stack has to be value (bool) of condition
@@ -91,11 +117,16 @@ void code_generator_var_declare_token(token_T token);
 void code_generator_var_declare(char* variable);
 
 /**
- * Creates eof label
+ * Creates eof label, optimizes generated code and prints it
  * @post free all malloc
 */
 void code_generator_eof();
 
+/**
+ * Frees generated code without printing it (used after error)
+*/
+void code_generator_dispose();
+
 /**
  * Pushs value of token to stack
  * @param token token to push (identifier/string/int/double)
@@ -158,11 +189,13 @@ void code_generator_operations(token_type_T operator, bool is_int);
 /**
  * @brief Creates code for ?? operator
  * @param id if id
+ * @param is_nil first operand is nil literal (result is always second operand)
  */
-void code_generator_nil_check(unsigned int id);
+void code_generator_nil_check(unsigned int id, bool is_nil);
 
 /**
  * Creates operation concat on stack
+ * (pushed operands are concatenated directly, chains are accumulated in one variable and literals are joined)
 */
 void code_generator_concats();
 
@@ -201,6 +234,7 @@ void code_generator_function_call_param_add(char* name, token_T value);
 
 /**
  * Converts int on stack in depth (0 is top) to float
+ * (conversion is inserted after instructions computing the int, pushed literal is converted at compile time)
  * @param depth depth in stack of converted int
  */
 void code_generator_int2doubles(int depth);
@@ -214,6 +248,7 @@ void code_generator_function_label_token(token_T token);
 
 /**
  * Maps function parameter from position ID to parameter name
+ * (parameter is used directly as LF@??_ID defined by caller)
  * @param param_name name of parameter
  * @param param_id position ID of parameter from 0
 */
@@ -221,12 +256,14 @@ void code_generator_param_map(char *param_name, unsigned param_id);
 
 /**
  * Creates label of function (declaration of header)
+ * @post body of function is generated to section laid out after main program
  * @param name name of function
 */
 void code_generator_function_label(char* name);
 
 /**
  * Closes function
+ * @post following code is generated to main program
  * @param name name of function
 */
 void code_generator_function_end(char* name);
@@ -238,12 +275,15 @@ void code_generator_function_end(char* name);
 void code_generator_return();
 
 /**
- * Generates code of ord function (internal code generator function)
+ * Generates inline code of ord function (literal is evaluated at compile time)
+ * @param operand operand with string argument
 */
-void code_generator_function_ord();
+void code_generator_ord(const char* operand);
 
 /**
- * Generates code of substring function (internal code generator function)
+ * Generates inline code of substring function with collected arguments
+ * (bounds given by literals are checked at compile time)
+ * @pre arguments are added by code_generator_function_call_param_add()
 */
 void code_generator_substring();
 
@@ -0,0 +1,131 @@
+/**
+ * @name IFJ23
+ * @file code_optimizer.h
+ * @brief Optimizations of generated IFJcode23 instructions
+ * @author Marie Kolarikova <xkolar77@stud.fit.vutbr.cz>
+ * @date 3.12.2023
+ **/
+
+#ifndef CODE_OPTIMIZER_H
+#define CODE_OPTIMIZER_H
+
+#include "code_buffer.h"
+#include "symtable.h"
+
+#define INLINE_MAX_SIZE 40   // maximal count of instructions in body of inlined function
+#define INLINE_ROUNDS 3      // count of inlining passes (callers can become leaf functions)
+#define TAIL_FOLLOW_LIMIT 16 // maximal count of labels and jumps between tail call and return
+#define ROTATE_MAX_SIZE 40   // maximal count of instructions in copied condition of rotated loop
+#define LIVENESS_MAX_VARIABLES 1024 // maximal count of local variables of function sharing frame slots
+#define PROGRAM_MAX_VARIABLES 4096 // maximal count of variables of program in analyses of whole program
+#define EVALUATE_CALL_FUEL 100000    // maximal count of jumps and calls executed by evaluation of one call at compile time
+#define EVALUATE_TOTAL_FUEL 1000000  // maximal count of jumps and calls executed by all evaluations at compile time
+#define CLONE_MIN_CALLS 2  // minimal count of calls passing the same constant argument to cloned function
+#define CLONE_MAX_SIZE 200 // maximal count of instructions of cloned function
+#define CLONE_BUDGET 400   // maximal count of instructions added by all clones
+
+/**
+ * Runs all optimizations on generated code
+ * @param code generated instructions
+ * @param symtable global symtable (NULL disables optimizations which need it)
+*/
+void code_optimizer_run(code_buffer_t *code, symtab_t *symtable);
+
+/**
+ * Replaces calls of pure functions with constant arguments by returned constant
+ * (pure function has no input, output or user global variable and calls only pure functions,
+ *  call is evaluated at compile time by interpreter with limited fuel)
+ * @param code generated instructions
+*/
+void code_optimizer_evaluate_calls(code_buffer_t *code);
+
+/**
+ * Replaces calls of small non-recursive leaf functions by their body
+ * @param code generated instructions
+ * @param symtable global symtable with information about recursion
+ * @return count of inlined calls
+*/
+unsigned code_optimizer_inline(code_buffer_t *code, symtab_t *symtable);
+
+/**
+ * Clones functions called with the same constant argument by several calls and redirects the calls to clones
+ * (parameter of clone is replaced by constant, comparisons of constants are folded and unreachable code is removed)
+ * @param code generated instructions
+ * @param symtable global symtable with information about recursion (recursive functions are not cloned)
+*/
+void code_optimizer_clone_functions(code_buffer_t *code, symtab_t *symtable);
+
+/**
+ * Removes functions, which are never called
+ * @param code generated instructions
+*/
+void code_optimizer_remove_unused_functions(code_buffer_t *code);
+
+/**
+ * Removes ?? operators, whose first operand is non-nil on all paths to operator
+ * (forward dataflow over basic blocks of program, nil comparisons of jumps refine their edges)
+ * @param code generated instructions
+*/
+void code_optimizer_remove_nil_checks(code_buffer_t *code);
+
+/**
+ * Replaces immutable variables assigned only once by literal or by copied variable
+ * @param code generated instructions
+*/
+void code_optimizer_propagate_copies(code_buffer_t *code);
+
+/**
+ * Removes variables, which are never read, and initializations overwritten on all paths before read
+ * (implicit nil of declaration without value, liveness analysis of whole program)
+ * @param code generated instructions
+*/
+void code_optimizer_eliminate_dead_stores(code_buffer_t *code);
+
+/**
+ * Replaces recursive calls in tail position by jump to the beginning of function
+ * (results combined by addition or multiplication of integers are collected in accumulator)
+ * @param code generated instructions
+ * @param symtable global symtable with types of functions
+*/
+void code_optimizer_eliminate_tail_calls(code_buffer_t *code, symtab_t *symtable);
+
+/**
+ * Replaces repeated computations in basic blocks by variable with their result
+ * @param code generated instructions
+*/
+void code_optimizer_eliminate_common_subexpressions(code_buffer_t *code);
+
+/**
+ * Moves computations, which do not change in while loop, before the loop
+ * @param code generated instructions
+*/
+void code_optimizer_hoist_invariants(code_buffer_t *code);
+
+/**
+ * Moves condition of while loops to the end of loop (condition at the beginning only guards first iteration)
+ * @param code generated instructions
+*/
+void code_optimizer_rotate_loops(code_buffer_t *code);
+
+/**
+ * Replaces conditions evaluated to bool on stack by conditional jumps on compared values
+ * (negations are folded to sense of jump)
+ * @param code generated instructions
+*/
+void code_optimizer_direct_branches(code_buffer_t *code);
+
+/**
+ * Lets local variables of function, which are never live at the same time, share one variable of frame
+ * (fewer variables are defined in every call)
+ * @param code generated instructions
+*/
+void code_optimizer_share_frame_slots(code_buffer_t *code);
+
+/**
+ * Replaces sequences of stack instructions by three-address instructions (PUSHS a, PUSHS b, ADDS, POPS c -> ADD c a b)
+ * (sequences are given by table of patterns)
+ * @param code generated instructions
+*/
+void code_optimizer_select_instructions(code_buffer_t *code);
+
+#endif
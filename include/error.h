@@ -24,6 +24,15 @@
 #define ERR_SEMANTIC 9              /*General sematic error*/
 #define ERR_INTERNAL 99             /*Internal program error*/
 
+#define ERR_RUN_SOURCE 51           /*Lexical or syntax error of interpreted IFJcode23*/
+#define ERR_RUN_SEMANTIC 52         /*Undefined or redefined label, redefined variable*/
+#define ERR_RUN_OPERAND_TYPE 53     /*Invalid types of operands*/
+#define ERR_RUN_UNDEFINED_VARIABLE 54 /*Access to undefined variable*/
+#define ERR_RUN_FRAME 55            /*Frame does not exist*/
+#define ERR_RUN_MISSING_VALUE 56    /*Uninitialized variable, empty data or call stack*/
+#define ERR_RUN_OPERAND_VALUE 57    /*Invalid value of operand (division by zero, EXIT)*/
+#define ERR_RUN_STRING 58           /*Invalid operation with string*/
+
 /**
  * @brief Prints error and message to stderr
  * 
@@ -0,0 +1,210 @@
+/**
+ * @name IFJ23
+ * @file interpreter.h
+ * @brief Interpreter of IFJcode23 programs with threaded dispatch over pre-decoded instructions
+ * @author Marie Kolarikova <xkolar77@stud.fit.vutbr.cz>
+ * @date 3.12.2023
+ **/
+
+#ifndef INTERPRETER_H
+#define INTERPRETER_H
+
+#include <stdio.h>
+#include <stdbool.h>
+#include "code_buffer.h"
+
+#define INTERPRETER_NO_INDEX ((unsigned)-1) // unresolved label or free slot of table
+#define INTERPRETER_NO_FUEL (-1)            // result of evaluation, which exceeded its limits
+#define INTERPRETER_EVALUATION_MAX_STRING 4096 // maximal length of string created by evaluation
+
+/**
+ * @brief type of value of variable or constant
+ */
+typedef enum {
+    VALUE_UNDECLARED,    // variable of global frame without DEFVAR
+    VALUE_UNINITIALIZED, // defined variable without value
+    VALUE_NIL,
+    VALUE_INT,
+    VALUE_FLOAT,
+    VALUE_BOOL,
+    VALUE_STRING
+} value_type_t;
+
+/**
+ * @brief immutable string shared by values (changed in place only by its only owner)
+ */
+typedef struct interpreter_string {
+    unsigned references;
+    size_t length;
+    size_t capacity;
+    char *chars;
+} interpreter_string_t;
+
+/**
+ * @brief value of variable, constant or item of data stack
+ */
+typedef struct interpreter_value {
+    value_type_t type;
+    union {
+        long long int_val;
+        double float_val;
+        bool bool_val;
+        interpreter_string_t *string_val;
+    } data;
+} interpreter_value_t;
+
+/**
+ * @brief kind of decoded operand
+ */
+typedef enum {
+    OPERAND_NONE,
+    OPERAND_CONSTANT,
+    OPERAND_GLOBAL,    // index of variable of global frame
+    OPERAND_LOCAL,     // id of name of variable of local frame
+    OPERAND_TEMPORARY, // id of name of variable of temporary frame
+    OPERAND_LABEL,     // index of labeled instruction
+    OPERAND_TYPE       // type read by READ (in constant)
+} operand_kind_t;
+
+/**
+ * @brief decoded operand of instruction
+ */
+typedef struct interpreter_operand {
+    operand_kind_t kind;
+    unsigned index;
+    interpreter_value_t constant;
+} interpreter_operand_t;
+
+/**
+ * @brief decoded instruction
+ */
+typedef struct interpreter_instruction {
+    const void *handler; // address of code executing instruction (threaded dispatch)
+    opcode_t opcode;
+    interpreter_operand_t operands[MAX_OPERANDS];
+    unsigned line;       // line of instruction in source code
+} interpreter_instruction_t;
+
+/**
+ * @brief table giving ids to names of variables and labels
+ */
+typedef struct interpreter_names {
+    char **names;       // names indexed by id
+    unsigned count;
+    unsigned *slots;    // ids in open addressing table
+    unsigned capacity;
+} interpreter_names_t;
+
+/**
+ * @brief decoded program
+ */
+typedef struct interpreter_program {
+    interpreter_instruction_t *instructions; // ended by implicit EXIT int@0
+    unsigned instruction_count;
+    unsigned instruction_capacity;
+    interpreter_names_t globals;             // variables of global frame
+    interpreter_names_t variables;           // variables of local and temporary frames
+    interpreter_names_t labels;
+    unsigned *label_positions;               // indexes of LABEL instructions by ids of labels
+    unsigned *source_lines;                  // lines of IFJ23 source by instructions (NULL without map, 0 if unknown)
+} interpreter_program_t;
+
+/**
+ * @brief execution counts collected by profiling run
+ */
+typedef struct interpreter_profile {
+    unsigned long long *instructions; // dispatches of every instruction
+    unsigned long long *calls;        // dispatches inside calls made by every CALL instruction (callee included)
+    unsigned long long dispatches;    // dispatches of all instructions
+} interpreter_profile_t;
+
+/**
+ * Initializes empty program
+ * @param program program to initialize
+*/
+void interpreter_program_init(interpreter_program_t *program);
+
+/**
+ * Frees decoded instructions and names of program
+ * @param program program to dispose
+*/
+void interpreter_program_dispose(interpreter_program_t *program);
+
+/**
+ * Decodes IFJcode23 source code (labels are resolved, names of variables get ids)
+ * @param program initialized empty program
+ * @param source IFJcode23 source code
+ * @return 0 or error code of interpreter (ERR_RUN_SOURCE, ERR_RUN_SEMANTIC, ERR_INTERNAL)
+*/
+int interpreter_load(interpreter_program_t *program, FILE *source);
+
+/**
+ * Decodes binary container of IFJcode23 (see code_binary.h), names and constants of its tables are decoded once
+ * @param program initialized empty program
+ * @param data content of container
+ * @param size size of content
+ * @return 0 or error code of interpreter (ERR_RUN_SOURCE, ERR_RUN_SEMANTIC, ERR_INTERNAL)
+*/
+int interpreter_load_binary(interpreter_program_t *program, const unsigned char *data, size_t size);
+
+/**
+ * Decodes generated instructions (for evaluation at compile time)
+ * @param program initialized empty program
+ * @param code generated instructions
+ * @return 0 or error code of interpreter (ERR_RUN_SOURCE, ERR_RUN_SEMANTIC, ERR_INTERNAL)
+*/
+int interpreter_load_code(interpreter_program_t *program, code_buffer_t *code);
+
+/**
+ * Reads map of source lines written by compiler (line "index line column" for every mapped instruction)
+ * @param program decoded program
+ * @param map map of source lines
+ * @return 0 or error code of interpreter (ERR_RUN_SOURCE for invalid map, ERR_INTERNAL)
+*/
+int interpreter_load_line_map(interpreter_program_t *program, FILE *map);
+
+/**
+ * Executes decoded program
+ * @param program decoded program
+ * @param input stream read by READ
+ * @param output stream written by WRITE
+ * @param debug DPRINT and BREAK print to stderr (ignored otherwise)
+ * @param profile counts of executed instructions (NULL runs without counting)
+ * @return operand of EXIT, 0 at the end of program or error code of interpreter
+*/
+int interpreter_run(interpreter_program_t *program, FILE *input, FILE *output, bool debug, interpreter_profile_t *profile);
+
+/**
+ * Evaluates decoded program without input and output, errors are not printed
+ * (fuel is consumed by every executed jump and call, created strings have limited length)
+ * @param program decoded program
+ * @param fuel remaining fuel (decreased by evaluation)
+ * @param literal constant of value on top of data stack at the end of program (NULL if stack is empty, has to be freed)
+ * @return 0, INTERPRETER_NO_FUEL or error code of interpreter
+*/
+int interpreter_evaluate(interpreter_program_t *program, unsigned long long *fuel, char **literal);
+
+/**
+ * Initializes zero counts for instructions of program
+ * @param profile profile to initialize
+ * @param program decoded program
+ * @return false on allocation error
+*/
+bool interpreter_profile_init(interpreter_profile_t *profile, interpreter_program_t *program);
+
+/**
+ * Frees counts of profile
+ * @param profile profile to dispose
+*/
+void interpreter_profile_dispose(interpreter_profile_t *profile);
+
+/**
+ * Prints dispatches per opcode, per region of labels, per call site and per line of IFJ23 source (if map was loaded)
+ * (regions of functions, while loops and else branches are named by source constructs of parser)
+ * @param profile counts of profiling run
+ * @param program profiled program
+ * @param report output stream
+*/
+void interpreter_profile_report(interpreter_profile_t *profile, interpreter_program_t *program, FILE *report);
+
+#endif
@@ -71,6 +71,17 @@ typedef union
     bool       is_nilable;
 } token_value_T;
 
+/**
+ * @brief position of token in source code (lines and columns are numbered from 1)
+ */
+typedef struct
+{
+    unsigned line;       //position of first char
+    unsigned column;
+    unsigned end_line;   //position of last char
+    unsigned end_column;
+} token_span_T;
+
 /**
  * @brief token type 
  */
@@ -79,6 +90,7 @@ typedef struct
     bool preceding_eol;//flag that signs preceding eol before processed token 
     token_type_T  type;
     token_value_T value;
+    token_span_T  span; //source code of token
 } token_T;
 
 typedef void state_T;
@@ -31,6 +31,7 @@ typedef struct parser_t {
     bool in_param;               // Parser should set param type
     bool return_found;           // Flag marking the presence of a return statement in a function
     bool first_stmt;             // Flag marking whether the current statement is the first one of the program or first inside if/while/function body
+    bool in_let;                 // Parser is inside declaration of immutable variable
     uint32_t in_cond;            // Parser is inside a condition statement
     uint32_t in_loop;            // Parser is inside a while loop
     uint32_t param_cnt;          // Current function parameter counter
@@ -129,6 +130,8 @@ typedef unsigned int Rule;
  * <stmt> <prog>
  * func ID ( <param_list> <func_ret_type> { <func_body> <prog>
  * EOF
+ *
+ * Right recursion of <prog>, <blk_body> and <func_body> is parsed iteratively
  */
 Rule prog(Parser* p);
 /**
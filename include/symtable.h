@@ -70,6 +70,7 @@ typedef struct symtab_item
     bool is_var_initialized; // true if item was assigned a value
     bool is_nillable;        // true if item can be nil
     bool variadic_param;     // true if a function can be passed whatever number of parameters
+    bool is_recursive;       // true if function calls itself (it can not be inlined)
     param_t *parameters;     // pointer to param_t struct
     Type return_type;        // anything but func
 } symtab_item_t;
@@ -22,6 +22,7 @@ typedef struct token_buffer_node {
 typedef struct {
     token_buffer_node_t head;
     token_buffer_node_t runner;
+    token_buffer_node_t tail; /* last element, push does not walk the list */
 } token_buffer_t;
 
 /**
@@ -0,0 +1,576 @@
+/**
+ * @name IFJ23
+ * @file code_binary.c
+ * @brief Compact binary container of IFJcode23 instructions
+ * @author Marie Kolarikova <xkolar77@stud.fit.vutbr.cz>
+ * @date 3.12.2023
+ **/
+
+#include "code_binary.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#define TABLE_INITIAL_CAPACITY 64 // power of 2
+#define NO_INDEX ((unsigned)-1)
+
+/**
+ * @brief growing array of encoded bytes
+ */
+typedef struct binary_buffer {
+    unsigned char *data;
+    size_t length;
+    size_t capacity;
+    bool error;         // allocation failed (later writes are ignored)
+} binary_buffer_t;
+
+/**
+ * @brief table of strings stored once (open addressing table of indexes)
+ */
+typedef struct binary_table {
+    const char **keys;  // strings indexed by their index (not copied)
+    unsigned count;
+    unsigned *slots;
+    unsigned capacity;
+} binary_table_t;
+
+/* ----------------------------------------------------------------- writer */
+
+/**
+ * Appends bytes to buffer
+ * @param buffer target buffer
+ * @param bytes appended bytes
+ * @param length count of bytes
+*/
+static void buffer_write(binary_buffer_t *buffer, const void *bytes, size_t length){
+    if(buffer->error){
+        return;
+    }
+
+    if(buffer->length + length > buffer->capacity){
+        size_t capacity = buffer->capacity == 0 ? 256 : buffer->capacity * 2;
+        while(capacity < buffer->length + length){
+            capacity *= 2;
+        }
+        unsigned char *resized = realloc(buffer->data, capacity);
+        if(resized == NULL){
+            buffer->error = true;
+            return;
+        }
+        buffer->data = resized;
+        buffer->capacity = capacity;
+    }
+
+    memcpy(buffer->data + buffer->length, bytes, length);
+    buffer->length += length;
+}
+
+/**
+ * Appends number as varint (7 bits per byte, the highest bit marks following byte)
+ * @param buffer target buffer
+ * @param value written number
+*/
+static void buffer_write_varint(binary_buffer_t *buffer, unsigned long long value){
+    unsigned char bytes[10];
+    unsigned length = 0;
+
+    do {
+        bytes[length] = value & 0x7f;
+        value >>= 7;
+        if(value != 0){
+            bytes[length] |= 0x80;
+        }
+        length++;
+    } while(value != 0);
+
+    buffer_write(buffer, bytes, length);
+}
+
+/**
+ * Appends string as length, chars and '\0'
+ * @param buffer target buffer
+ * @param chars chars of string
+ * @param length count of chars
+*/
+static void buffer_write_string(binary_buffer_t *buffer, const char *chars, size_t length){
+    buffer_write_varint(buffer, length);
+    buffer_write(buffer, chars, length);
+    buffer_write(buffer, "", 1);
+}
+
+/**
+ * Computes hash of string (djb2)
+*/
+static unsigned table_hash(const char *key, unsigned capacity){
+    unsigned hash = 5381;
+    for(const unsigned char *c = (const unsigned char *)key; *c != '\0'; c++){
+        hash = hash * 33 + *c;
+    }
+    return hash & (capacity - 1);
+}
+
+/**
+ * Finds index of string or adds it to table
+ * @param table table of strings
+ * @param key string (it has to live as long as table)
+ * @return index of string or NO_INDEX on allocation error
+*/
+static unsigned table_add(binary_table_t *table, const char *key){
+    // table is kept at most half full
+    if(table->count * 2 >= table->capacity){
+        unsigned capacity = table->capacity == 0 ? TABLE_INITIAL_CAPACITY : table->capacity * 2;
+        unsigned *slots = malloc(capacity * sizeof(unsigned));
+        const char **keys = realloc(table->keys, capacity * sizeof(const char *));
+        if(slots == NULL || keys == NULL){
+            free(slots);
+            if(keys != NULL){
+                table->keys = keys;
+            }
+            return NO_INDEX;
+        }
+
+        for(unsigned i = 0; i < capacity; i++){
+            slots[i] = NO_INDEX;
+        }
+        for(unsigned index = 0; index < table->count; index++){
+            unsigned slot = table_hash(keys[index], capacity);
+            while(slots[slot] != NO_INDEX){
+                slot = (slot + 1) & (capacity - 1);
+            }
+            slots[slot] = index;
+        }
+
+        free(table->slots);
+        table->slots = slots;
+        table->keys = keys;
+        table->capacity = capacity;
+    }
+
+    unsigned slot = table_hash(key, table->capacity);
+    while(table->slots[slot] != NO_INDEX){
+        if(strcmp(table->keys[table->slots[slot]], key) == 0){
+            return table->slots[slot];
+        }
+        slot = (slot + 1) & (table->capacity - 1);
+    }
+
+    table->keys[table->count] = key;
+    table->slots[slot] = table->count;
+    return table->count++;
+}
+
+/**
+ * Frees table (strings are not owned by table)
+*/
+static void table_dispose(binary_table_t *table){
+    free(table->keys);
+    free(table->slots);
+}
+
+/**
+ * Encodes operand and adds its name or constant to tables
+ * @param opcode opcode of instruction
+ * @param position position of operand in instruction
+ * @param operand text of operand
+ * @param names table of names
+ * @param constants table of constants (texts of constants)
+ * @param stream encoded instructions
+ * @return false on allocation error
+*/
+static bool write_operand(opcode_t opcode, unsigned position, const char *operand, binary_table_t *names,
+                          binary_table_t *constants, binary_buffer_t *stream){
+    binary_operand_kind_t kind;
+    unsigned index;
+
+    if(operand_is_variable(operand)){
+        kind = operand_in_frame(operand, "GF") ? BINARY_GLOBAL : operand_in_frame(operand, "LF") ? BINARY_LOCAL : BINARY_TEMPORARY;
+        index = table_add(names, operand + 3);
+    } else if(operand_is_constant(operand)){
+        kind = BINARY_CONSTANT;
+        index = table_add(constants, operand);
+    } else {
+        kind = opcode == OP_READ && position == 1 ? BINARY_TYPE : BINARY_LABEL;
+        index = table_add(names, operand);
+    }
+
+    if(index == NO_INDEX){
+        return false;
+    }
+    buffer_write_varint(stream, (unsigned long long)index << 3 | kind);
+    return true;
+}
+
+/**
+ * Encodes constant of pool
+ * @param buffer target buffer
+ * @param text text of constant (type@value)
+ * @return false if constant is invalid or on allocation error
+*/
+static bool write_constant(binary_buffer_t *buffer, const char *text){
+    const char *value = strchr(text, '@') + 1;
+    char *end = NULL;
+
+    if(strncmp(text, "int@", 4) == 0){
+        long long number = strtoll(value, &end, 10);
+        if(*value == '\0' || *end != '\0'){
+            return false;
+        }
+        unsigned char type = BINARY_INT;
+        buffer_write(buffer, &type, 1);
+        // zigzag keeps small negative numbers short
+        buffer_write_varint(buffer, ((unsigned long long)number << 1) ^ (unsigned long long)(number >> 63));
+    } else if(strncmp(text, "float@", 6) == 0){
+        double number = strtod(value, &end);
+        if(*value == '\0' || *end != '\0'){
+            return false;
+        }
+        uint64_t bits;
+        memcpy(&bits, &number, sizeof(bits));
+        unsigned char bytes[9] = {BINARY_FLOAT};
+        for(unsigned i = 0; i < 8; i++){
+            bytes[i + 1] = (unsigned char)(bits >> (8 * i));
+        }
+        buffer_write(buffer, bytes, sizeof(bytes));
+    } else if(strncmp(text, "bool@", 5) == 0){
+        if(strcmp(value, "true") != 0 && strcmp(value, "false") != 0){
+            return false;
+        }
+        unsigned char bytes[2] = {BINARY_BOOL, value[0] == 't'};
+        buffer_write(buffer, bytes, sizeof(bytes));
+    } else if(strncmp(text, "nil@", 4) == 0){
+        unsigned char type = BINARY_NIL;
+        buffer_write(buffer, &type, 1);
+    } else {
+        // escape sequences are replaced by chars (decoded string is never longer)
+        char *chars = malloc(strlen(value) + 1);
+        if(chars == NULL){
+            return false;
+        }
+        size_t length = 0;
+        for(const char *c = value; *c != '\0'; c++){
+            if(*c == '\\' && c[1] >= '0' && c[1] <= '9' && c[2] >= '0' && c[2] <= '9' && c[3] >= '0' && c[3] <= '9'){
+                chars[length++] = (char)((c[1] - '0') * 100 + (c[2] - '0') * 10 + (c[3] - '0'));
+                c += 3;
+            } else {
+                chars[length++] = *c;
+            }
+        }
+        unsigned char type = BINARY_STRING;
+        buffer_write(buffer, &type, 1);
+        buffer_write_string(buffer, chars, length);
+        free(chars);
+    }
+
+    return true;
+}
+
+bool code_binary_write(code_buffer_t *code, FILE *file){
+    binary_table_t names = {NULL, 0, NULL, 0};
+    binary_table_t constants = {NULL, 0, NULL, 0};
+    binary_buffer_t stream = {NULL, 0, 0, false};
+    binary_buffer_t output = {NULL, 0, 0, false};
+    unsigned count = 0;
+    bool result = true;
+
+    // instructions are encoded first, tables are complete after them
+    for(instruction_t *instruction = code->head; instruction != NULL && result; instruction = instruction->next, count++){
+        if(instruction->opcode == OP_UNKNOWN || instruction->operand_count != instruction_table[instruction->opcode].operand_count){
+            result = false;
+            break;
+        }
+
+        buffer_write_varint(&stream, (unsigned long long)instruction->opcode << 1 | instruction->blank_line);
+        for(unsigned i = 0; i < instruction->operand_count && result; i++){
+            result = write_operand(instruction->opcode, i, instruction->operands[i], &names, &constants, &stream);
+        }
+    }
+
+    if(result){
+        buffer_write(&output, CODE_BINARY_MAGIC, CODE_BINARY_MAGIC_LENGTH);
+        buffer_write_varint(&output, names.count);
+        for(unsigned i = 0; i < names.count; i++){
+            buffer_write_string(&output, names.keys[i], strlen(names.keys[i]));
+        }
+        buffer_write_varint(&output, constants.count);
+        for(unsigned i = 0; i < constants.count && result; i++){
+            result = write_constant(&output, constants.keys[i]);
+        }
+        buffer_write_varint(&output, count);
+        buffer_write(&output, stream.data, stream.length);
+    }
+
+    result = result && !stream.error && !output.error && fwrite(output.data, 1, output.length, file) == output.length;
+
+    table_dispose(&names);
+    table_dispose(&constants);
+    free(stream.data);
+    free(output.data);
+    return result;
+}
+
+/* ----------------------------------------------------------------- reader */
+
+/**
+ * Reads varint
+ * @param binary opened container
+ * @param position offset of varint (moved after it)
+ * @param value read number
+ * @return false if varint exceeds container
+*/
+static bool read_varint(code_binary_t *binary, size_t *position, unsigned long long *value){
+    *value = 0;
+    for(unsigned shift = 0; shift < 64 && *position < binary->size; shift += 7){
+        unsigned char byte = binary->data[(*position)++];
+        *value |= (unsigned long long)(byte & 0x7f) << shift;
+        if((byte & 0x80) == 0){
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Reads count of table (count has to fit into rest of container)
+ * @param binary opened container
+ * @param position offset of count (moved after it)
+ * @param count read count
+ * @return false if count is invalid
+*/
+static bool read_count(code_binary_t *binary, size_t *position, unsigned *count){
+    unsigned long long value;
+    if(!read_varint(binary, position, &value) || value > binary->size - *position){
+        return false;
+    }
+    *count = (unsigned)value;
+    return true;
+}
+
+/**
+ * Reads string written by buffer_write_string
+ * @param binary opened container
+ * @param position offset of string (moved after it)
+ * @param chars chars of string in container
+ * @param length count of chars
+ * @return false if string is invalid
+*/
+static bool read_string(code_binary_t *binary, size_t *position, const char **chars, size_t *length){
+    unsigned long long value;
+    if(!read_varint(binary, position, &value) || value >= binary->size - *position || binary->data[*position + value] != '\0'){
+        return false;
+    }
+    *chars = (const char *)binary->data + *position;
+    *length = (size_t)value;
+    *position += value + 1;
+    return true;
+}
+
+/**
+ * Reads constant of pool
+ * @param binary opened container
+ * @param position offset of constant (moved after it)
+ * @param constant read constant
+ * @return false if constant is invalid
+*/
+static bool read_constant(code_binary_t *binary, size_t *position, binary_constant_t *constant){
+    if(*position >= binary->size){
+        return false;
+    }
+    memset(constant, 0, sizeof(binary_constant_t));
+    constant->type = binary->data[(*position)++];
+
+    unsigned long long value;
+    switch(constant->type){
+        case BINARY_NIL:
+            return true;
+        case BINARY_INT:
+            if(!read_varint(binary, position, &value)){
+                return false;
+            }
+            constant->int_val = (long long)(value >> 1) ^ -(long long)(value & 1);
+            return true;
+        case BINARY_FLOAT: {
+            if(binary->size - *position < 8){
+                return false;
+            }
+            uint64_t bits = 0;
+            for(unsigned i = 0; i < 8; i++){
+                bits |= (uint64_t)binary->data[*position + i] << (8 * i);
+            }
+            memcpy(&constant->float_val, &bits, sizeof(bits));
+            *position += 8;
+            return true;
+        }
+        case BINARY_BOOL:
+            if(*position >= binary->size || binary->data[*position] > 1){
+                return false;
+            }
+            constant->bool_val = binary->data[(*position)++] == 1;
+            return true;
+        case BINARY_STRING:
+            return read_string(binary, position, &constant->string_val, &constant->length);
+        default:
+            return false;
+    }
+}
+
+bool code_binary_open(code_binary_t *binary, const unsigned char *data, size_t size){
+    memset(binary, 0, sizeof(code_binary_t));
+    binary->data = data;
+    binary->size = size;
+
+    if(size < CODE_BINARY_MAGIC_LENGTH || memcmp(data, CODE_BINARY_MAGIC, CODE_BINARY_MAGIC_LENGTH) != 0){
+        return false;
+    }
+    size_t position = CODE_BINARY_MAGIC_LENGTH;
+
+    // every name and constant takes at least one byte, so counts are limited by size of container
+    if(!read_count(binary, &position, &binary->name_count) ||
+       (binary->names = malloc((binary->name_count + 1) * sizeof(const char *))) == NULL){
+        code_binary_close(binary);
+        return false;
+    }
+    for(unsigned i = 0; i < binary->name_count; i++){
+        size_t length;
+        if(!read_string(binary, &position, &binary->names[i], &length)){
+            code_binary_close(binary);
+            return false;
+        }
+    }
+
+    if(!read_count(binary, &position, &binary->constant_count) ||
+       (binary->constants = malloc((binary->constant_count + 1) * sizeof(binary_constant_t))) == NULL){
+        code_binary_close(binary);
+        return false;
+    }
+    for(unsigned i = 0; i < binary->constant_count; i++){
+        if(!read_constant(binary, &position, &binary->constants[i])){
+            code_binary_close(binary);
+            return false;
+        }
+    }
+
+    if(!read_count(binary, &position, &binary->instruction_count)){
+        code_binary_close(binary);
+        return false;
+    }
+    binary->instructions = position;
+    return true;
+}
+
+void code_binary_close(code_binary_t *binary){
+    free(binary->names);
+    free(binary->constants);
+    binary->names = NULL;
+    binary->constants = NULL;
+}
+
+bool code_binary_next(code_binary_t *binary, size_t *position, binary_instruction_t *instruction){
+    unsigned long long value;
+    if(!read_varint(binary, position, &value) || (value >> 1) >= OP_UNKNOWN){
+        return false;
+    }
+    instruction->opcode = (opcode_t)(value >> 1);
+    instruction->blank_line = value & 1;
+
+    for(unsigned i = 0; i < instruction_table[instruction->opcode].operand_count; i++){
+        if(!read_varint(binary, position, &value)){
+            return false;
+        }
+        binary_operand_t *operand = &instruction->operands[i];
+        operand->kind = value & 7;
+        value >>= 3;
+
+        unsigned limit = operand->kind == BINARY_CONSTANT ? binary->constant_count : binary->name_count;
+        if(operand->kind > BINARY_TYPE || value >= limit){
+            return false;
+        }
+        operand->index = (unsigned)value;
+    }
+
+    return true;
+}
+
+/**
+ * Appends operand in text form
+ * @param binary opened container
+ * @param operand decoded operand
+ * @param text target text
+*/
+static void read_operand(code_binary_t *binary, binary_operand_t *operand, dstring_t *text){
+    const char *frames[] = {"", "GF@", "LF@", "TF@", "", ""};
+
+    if(operand->kind != BINARY_CONSTANT){
+        dstring_add_const_str(text, frames[operand->kind]);
+        dstring_add_const_str(text, binary->names[operand->index]);
+        return;
+    }
+
+    binary_constant_t *constant = &binary->constants[operand->index];
+    char number[64];
+    switch(constant->type){
+        case BINARY_NIL:
+            dstring_add_const_str(text, "nil@nil");
+            break;
+        case BINARY_INT:
+            snprintf(number, sizeof(number), "int@%lld", constant->int_val);
+            dstring_add_const_str(text, number);
+            break;
+        case BINARY_FLOAT:
+            snprintf(number, sizeof(number), "float@%a", constant->float_val);
+            dstring_add_const_str(text, number);
+            break;
+        case BINARY_BOOL:
+            dstring_add_const_str(text, constant->bool_val ? "bool@true" : "bool@false");
+            break;
+        default:
+            dstring_add_const_str(text, "string@");
+            for(size_t i = 0; i < constant->length; i++){
+                unsigned char c = (unsigned char)constant->string_val[i];
+                if(c <= 32 || c == '#' || c == '\\'){
+                    snprintf(number, sizeof(number), "\\%03d", c);
+                    dstring_add_const_str(text, number);
+                } else {
+                    dstring_append(text, (char)c);
+                }
+            }
+            break;
+    }
+}
+
+bool code_binary_read(code_binary_t *binary, code_buffer_t *code){
+    dstring_t operands[MAX_OPERANDS];
+    for(unsigned i = 0; i < MAX_OPERANDS; i++){
+        dstring_init(&operands[i]);
+    }
+
+    size_t position = binary->instructions;
+    bool result = true;
+
+    for(unsigned i = 0; i < binary->instruction_count && result; i++){
+        binary_instruction_t decoded;
+        if(!code_binary_next(binary, &position, &decoded)){
+            result = false;
+            break;
+        }
+
+        unsigned count = instruction_table[decoded.opcode].operand_count;
+        for(unsigned j = 0; j < count; j++){
+            dstring_clear(&operands[j]);
+            read_operand(binary, &decoded.operands[j], &operands[j]);
+        }
+
+        instruction_t *instruction = instruction_create(decoded.opcode, count > 0 ? operands[0].str : NULL,
+                                                        count > 1 ? operands[1].str : NULL, count > 2 ? operands[2].str : NULL);
+        if(instruction == NULL){
+            result = false;
+            break;
+        }
+        instruction->blank_line = decoded.blank_line;
+        code_buffer_append(code, instruction);
+    }
+
+    for(unsigned i = 0; i < MAX_OPERANDS; i++){
+        dstring_free(&operands[i]);
+    }
+    return result;
+}
@@ -0,0 +1,331 @@
+/**
+ * @name IFJ23
+ * @file code_buffer.c
+ * @brief Buffer of generated IFJcode23 instructions
+ * @author Marie Kolarikova <xkolar77@stud.fit.vutbr.cz>
+ * @date 3.12.2023
+ **/
+
+#include "code_buffer.h"
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+const instruction_info_t instruction_table[OP_UNKNOWN] = {
+    [OP_MOVE]        = {"MOVE", 2, true},
+    [OP_CREATEFRAME] = {"CREATEFRAME", 0, false},
+    [OP_PUSHFRAME]   = {"PUSHFRAME", 0, false},
+    [OP_POPFRAME]    = {"POPFRAME", 0, false},
+    [OP_DEFVAR]      = {"DEFVAR", 1, true},
+    [OP_CALL]        = {"CALL", 1, false},
+    [OP_RETURN]      = {"RETURN", 0, false},
+    [OP_PUSHS]       = {"PUSHS", 1, false},
+    [OP_POPS]        = {"POPS", 1, true},
+    [OP_CLEARS]      = {"CLEARS", 0, false},
+    [OP_ADD]         = {"ADD", 3, true},
+    [OP_SUB]         = {"SUB", 3, true},
+    [OP_MUL]         = {"MUL", 3, true},
+    [OP_DIV]         = {"DIV", 3, true},
+    [OP_IDIV]        = {"IDIV", 3, true},
+    [OP_ADDS]        = {"ADDS", 0, false},
+    [OP_SUBS]        = {"SUBS", 0, false},
+    [OP_MULS]        = {"MULS", 0, false},
+    [OP_DIVS]        = {"DIVS", 0, false},
+    [OP_IDIVS]       = {"IDIVS", 0, false},
+    [OP_LT]          = {"LT", 3, true},
+    [OP_GT]          = {"GT", 3, true},
+    [OP_EQ]          = {"EQ", 3, true},
+    [OP_LTS]         = {"LTS", 0, false},
+    [OP_GTS]         = {"GTS", 0, false},
+    [OP_EQS]         = {"EQS", 0, false},
+    [OP_AND]         = {"AND", 3, true},
+    [OP_OR]          = {"OR", 3, true},
+    [OP_NOT]         = {"NOT", 2, true},
+    [OP_ANDS]        = {"ANDS", 0, false},
+    [OP_ORS]         = {"ORS", 0, false},
+    [OP_NOTS]        = {"NOTS", 0, false},
+    [OP_INT2FLOAT]   = {"INT2FLOAT", 2, true},
+    [OP_FLOAT2INT]   = {"FLOAT2INT", 2, true},
+    [OP_INT2CHAR]    = {"INT2CHAR", 2, true},
+    [OP_STRI2INT]    = {"STRI2INT", 3, true},
+    [OP_INT2FLOATS]  = {"INT2FLOATS", 0, false},
+    [OP_FLOAT2INTS]  = {"FLOAT2INTS", 0, false},
+    [OP_INT2CHARS]   = {"INT2CHARS", 0, false},
+    [OP_STRI2INTS]   = {"STRI2INTS", 0, false},
+    [OP_READ]        = {"READ", 2, true},
+    [OP_WRITE]       = {"WRITE", 1, false},
+    [OP_CONCAT]      = {"CONCAT", 3, true},
+    [OP_STRLEN]      = {"STRLEN", 2, true},
+    [OP_GETCHAR]     = {"GETCHAR", 3, true},
+    [OP_SETCHAR]     = {"SETCHAR", 3, true},
+    [OP_TYPE]        = {"TYPE", 2, true},
+    [OP_LABEL]       = {"LABEL", 1, false},
+    [OP_JUMP]        = {"JUMP", 1, false},
+    [OP_JUMPIFEQ]    = {"JUMPIFEQ", 3, false},
+    [OP_JUMPIFNEQ]   = {"JUMPIFNEQ", 3, false},
+    [OP_JUMPIFEQS]   = {"JUMPIFEQS", 1, false},
+    [OP_JUMPIFNEQS]  = {"JUMPIFNEQS", 1, false},
+    [OP_EXIT]        = {"EXIT", 1, false},
+    [OP_BREAK]       = {"BREAK", 0, false},
+    [OP_DPRINT]      = {"DPRINT", 1, false},
+};
+
+/**
+ * Copies string to newly allocated memory (strdup is not part of C99)
+ * @param str copied string
+ * @param length count of copied chars
+ * @return copy of string or NULL on allocation error
+*/
+static char *copy_string(const char *str, size_t length){
+    char *copy = malloc(length + 1);
+    if(copy == NULL){
+        fprintf(stderr, "code_buffer: copy_string: allocation failed.\n");
+        return NULL;
+    }
+    memcpy(copy, str, length);
+    copy[length] = '\0';
+    return copy;
+}
+
+void code_buffer_init(code_buffer_t *buffer){
+    buffer->head = NULL;
+    buffer->tail = NULL;
+}
+
+void code_buffer_dispose(code_buffer_t *buffer){
+    instruction_t *instruction = buffer->head;
+
+    while(instruction != NULL){
+        instruction_t *next = instruction->next;
+        instruction_free(instruction);
+        instruction = next;
+    }
+
+    code_buffer_init(buffer);
+}
+
+instruction_t *instruction_create(opcode_t opcode, const char *op1, const char *op2, const char *op3){
+    instruction_t *instruction = calloc(1, sizeof(instruction_t));
+    if(instruction == NULL){
+        fprintf(stderr, "code_buffer: instruction_create: allocation failed.\n");
+        return NULL;
+    }
+
+    instruction->opcode = opcode;
+
+    const char *operands[MAX_OPERANDS] = {op1, op2, op3};
+    for(unsigned i = 0; i < MAX_OPERANDS && operands[i] != NULL; i++){
+        instruction->operands[i] = copy_string(operands[i], strlen(operands[i]));
+        instruction->operand_count++;
+    }
+
+    return instruction;
+}
+
+opcode_t instruction_opcode(const char *name){
+    // names of instructions are case insensitive (table contains upper case names)
+    for(unsigned i = 0; i < OP_UNKNOWN; i++){
+        const char *table_name = instruction_table[i].name;
+        const char *c = name;
+        while(*c != '\0' && toupper((unsigned char)*c) == *table_name){
+            c++;
+            table_name++;
+        }
+
+        if(*c == '\0' && *table_name == '\0'){
+            return (opcode_t)i;
+        }
+    }
+
+    return OP_UNKNOWN;
+}
+
+instruction_t *instruction_parse(const char *line){
+    instruction_t *instruction = calloc(1, sizeof(instruction_t));
+    if(instruction == NULL){
+        fprintf(stderr, "code_buffer: instruction_parse: allocation failed.\n");
+        return NULL;
+    }
+
+    // opcode
+    while(*line == ' ' || *line == '\t') line++;
+    size_t length = strcspn(line, " \t");
+
+    char *name = copy_string(line, length);
+    if(name == NULL){
+        free(instruction);
+        return NULL;
+    }
+    instruction->opcode = instruction_opcode(name);
+    free(name);
+    line += length;
+
+    // operands (escaped strings do not contain white spaces)
+    while(instruction->operand_count < MAX_OPERANDS){
+        while(*line == ' ' || *line == '\t') line++;
+        if(*line == '\0') break;
+
+        length = strcspn(line, " \t");
+        instruction->operands[instruction->operand_count++] = copy_string(line, length);
+        line += length;
+    }
+
+    return instruction;
+}
+
+instruction_t *instruction_copy(instruction_t *instruction){
+    instruction_t *copy = instruction_create(
+        instruction->opcode,
+        instruction->operands[0],
+        instruction->operand_count > 1 ? instruction->operands[1] : NULL,
+        instruction->operand_count > 2 ? instruction->operands[2] : NULL
+    );
+
+    if(copy != NULL){
+        copy->blank_line = instruction->blank_line;
+        copy->is_constant = instruction->is_constant;
+        copy->line = instruction->line;
+        copy->column = instruction->column;
+    }
+
+    return copy;
+}
+
+void instruction_free(instruction_t *instruction){
+    for(unsigned i = 0; i < instruction->operand_count; i++){
+        free(instruction->operands[i]);
+    }
+    free(instruction);
+}
+
+void instruction_set_operand(instruction_t *instruction, unsigned index, const char *operand){
+    if(index >= MAX_OPERANDS){
+        return;
+    }
+
+    char *copy = copy_string(operand, strlen(operand));
+    if(copy == NULL){
+        return;
+    }
+
+    if(index < instruction->operand_count){
+        free(instruction->operands[index]);
+    } else {
+        instruction->operand_count = index + 1;
+    }
+    instruction->operands[index] = copy;
+}
+
+void code_buffer_append(code_buffer_t *buffer, instruction_t *instruction){
+    code_buffer_insert_after(buffer, buffer->tail, instruction);
+}
+
+void code_buffer_concat(code_buffer_t *buffer, code_buffer_t *other){
+    if(other->head == NULL){
+        return;
+    }
+
+    if(buffer->tail == NULL){
+        buffer->head = other->head;
+    } else {
+        buffer->tail->next = other->head;
+        other->head->prev = buffer->tail;
+    }
+    buffer->tail = other->tail;
+
+    code_buffer_init(other);
+}
+
+void code_buffer_insert_before(code_buffer_t *buffer, instruction_t *position, instruction_t *instruction){
+    if(position == NULL){
+        code_buffer_insert_after(buffer, buffer->tail, instruction);
+    } else {
+        code_buffer_insert_after(buffer, position->prev, instruction);
+    }
+}
+
+void code_buffer_insert_after(code_buffer_t *buffer, instruction_t *position, instruction_t *instruction){
+    if(instruction == NULL){
+        return;
+    }
+
+    instruction->prev = position;
+
+    if(position == NULL){
+        instruction->next = buffer->head;
+        buffer->head = instruction;
+    } else {
+        instruction->next = position->next;
+        position->next = instruction;
+    }
+
+    if(instruction->next == NULL){
+        buffer->tail = instruction;
+    } else {
+        instruction->next->prev = instruction;
+    }
+}
+
+void code_buffer_unlink(code_buffer_t *buffer, instruction_t *instruction){
+    if(instruction->prev == NULL){
+        buffer->head = instruction->next;
+    } else {
+        instruction->prev->next = instruction->next;
+    }
+
+    if(instruction->next == NULL){
+        buffer->tail = instruction->prev;
+    } else {
+        instruction->next->prev = instruction->prev;
+    }
+
+    instruction->next = NULL;
+    instruction->prev = NULL;
+}
+
+instruction_t *code_buffer_remove(code_buffer_t *buffer, instruction_t *instruction){
+    instruction_t *next = instruction->next;
+
+    code_buffer_unlink(buffer, instruction);
+    instruction_free(instruction);
+
+    return next;
+}
+
+void code_buffer_print(code_buffer_t *buffer, FILE *file){
+    for(instruction_t *instruction = buffer->head; instruction != NULL; instruction = instruction->next){
+        if(instruction->blank_line){
+            fputc('\n', file);
+        }
+
+        fputs(instruction->opcode < OP_UNKNOWN ? instruction_table[instruction->opcode].name : "#", file);
+
+        for(unsigned i = 0; i < instruction->operand_count; i++){
+            fputc(' ', file);
+            fputs(instruction->operands[i], file);
+        }
+
+        fputc('\n', file);
+    }
+}
+
+bool operand_is_variable(const char *operand){
+    return operand_in_frame(operand, "GF") || operand_in_frame(operand, "LF") || operand_in_frame(operand, "TF");
+}
+
+bool operand_is_constant(const char *operand){
+    const char *prefixes[] = {"int@", "float@", "string@", "bool@", "nil@"};
+    const unsigned prefixes_count = 5;
+
+    for(unsigned i = 0; i < prefixes_count; i++){
+        if(strncmp(operand, prefixes[i], strlen(prefixes[i])) == 0){
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool operand_in_frame(const char *operand, const char *frame){
+    return operand != NULL && strncmp(operand, frame, 2) == 0 && operand[2] == '@';
+}
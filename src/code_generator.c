@@ -7,6 +7,9 @@
  **/
 
 #include "code_generator.h"
+#include "code_buffer.h"
+#include "code_binary.h"
+#include "code_optimizer.h"
 #include "debug.h"
 #include <stdio.h>
 
@@ -23,9 +26,42 @@
     free(sprintf_data);                                        \
 }
 
+/**
+ * @brief variable of compact output
+ */
+typedef struct compact_name {
+    char* name;   // name of variable without frame
+    unsigned uses; // count of operands with variable
+    unsigned id;   // id of short name (the most used variables get the shortest names)
+} compact_name_t;
+
+/**
+ * @brief parameter of generated function (read directly from frame of arguments)
+ */
+typedef struct param_slot {
+    char* name;   // name of parameter
+    unsigned uid; // unique id of parameter
+} param_slot_t;
+
 unsigned func_param_id = 0; //id of parameter, which will be added to function call
 unsigned for_open = 0;      //count of open for cycles
-dstring_t print_buffer;     //string of print buffer
+dstring_t line_buffer;      //currently assembled line of code
+bool blank_line = false;    //next instruction is preceded by empty line
+code_buffer_t code;         //generated instructions of main program
+code_buffer_t functions;    //generated instructions of function bodies (laid out after main program)
+code_buffer_t* section = &code; //section, to which are instructions generated
+instruction_t* loop_start = NULL; //label of outermost open for cycle
+param_slot_t* param_slots = NULL; //parameters of generated function indexed by position ID
+unsigned param_count = 0;         //count of parameters of generated function
+unsigned builtin_id = 0;          //id of inlined builtin function, used in its labels
+char* substring_args[3] = {NULL, NULL, NULL}; //operands of arguments of inlined substring
+unsigned substring_arg_count = 0; //count of collected arguments of substring
+unsigned source_line = 0;         //source line of currently generated statement (0 if unknown)
+unsigned source_column = 0;       //source column of currently generated statement
+const char* line_map_path = NULL; //file of generated map of source lines (NULL if map is not generated)
+const char* binary_path = NULL;   //file of generated binary container (NULL if container is not generated)
+bool compact_mode = false;        //variables get short names and blank lines are not printed
+const char* name_map_path = NULL; //file of generated map of short names of compact output (NULL if map is not generated)
 
 symtab_t* global_symtable = NULL; //pointer to global symtable
 scope_t*  scope_stack = NULL;     //pointer to scope stack
@@ -38,7 +74,13 @@ void code_generator_set_current_symtable(symtab_t* g_symtable, scope_t* stack) {
     scope_stack = stack;
 }
 
-unsigned code_generator_get_var_uid(char *varname, bool initialized){
+/**
+ * Finds variable in scope stack or in global symtable
+ * @param varname name of variable
+ * @param initialized if variable has to be initialized
+ * @return item of variable or NULL if it was not found
+ */
+static symtab_item_t* code_generator_get_var_item(char *varname, bool initialized){
     dstring_t dynamic_varname;
     dstring_init(&dynamic_varname);
     dstring_add_const_str(&dynamic_varname, varname);
@@ -48,7 +90,7 @@ unsigned code_generator_get_var_uid(char *varname, bool initialized){
     if(scope_stack == NULL){
         WARNING_PRINT("Current scope stack is null. Function used implicit 0.");
         dstring_free(&dynamic_varname);
-        return 0;
+        return NULL;
     }
 
     symtab_item_t* item;
@@ -60,26 +102,32 @@ unsigned code_generator_get_var_uid(char *varname, bool initialized){
 
     if(error == SYMTAB_OK){
         dstring_free(&dynamic_varname);
-        return item->uid;
+        return item;
     }
 
     if(global_symtable == NULL){
         WARNING_PRINT("Current symtable is null. Function used implicit 0.");
         dstring_free(&dynamic_varname);
-        return 0;
+        return NULL;
     }
 
     item = symtable_search(global_symtable, &dynamic_varname, &error);
 
     if(error == SYMTAB_OK){
         dstring_free(&dynamic_varname);
-        return item->uid;
+        return item;
     }
 
     WARNING_PRINT("Variable was not found in symtable. Function used implicit 0.");
     dstring_free(&dynamic_varname);
 
-    return 0;
+    return NULL;
+}
+
+unsigned code_generator_get_var_uid(char *varname, bool initialized){
+    symtab_item_t* item = code_generator_get_var_item(varname, initialized);
+
+    return item != NULL ? item->uid : 0;
 }
 
 const char* code_generator_get_var_frame(char *varname, bool initialized){
@@ -133,13 +181,45 @@ void code_generator_defvar_token(token_T token){
     );
 }
 
+/**
+ * Creates variable definition and returns created instruction
+ * @param frame frame of declared variable
+ * @param varname name of declared variable
+ * @param id id of declared variable
+ * @return DEFVAR instruction or NULL on allocation error
+*/
+static instruction_t* code_generator_defvar_instruction(const char *frame, char *varname, unsigned id){
+    int   name_size = snprintf(NULL, 0, "%s@%s_%d", frame, varname, id);
+    char* name_data = malloc(name_size + 1);
+    sprintf(name_data, "%s@%s_%d", frame, varname, id);
+
+    instruction_t* instruction = instruction_create(OP_DEFVAR, name_data, NULL, NULL);
+    free(name_data);
+    if(instruction == NULL){
+        return NULL;
+    }
+    instruction->blank_line = true;
+    instruction->line = source_line;
+    instruction->column = source_column;
+
+    // variables are defined before the outermost cycle, so they are not redefined in every iteration
+    // (arguments in temporary frame have to stay next to CREATEFRAME)
+    if(for_open > 0 && strcmp(frame, "TF") != 0){
+        code_buffer_insert_before(section, loop_start, instruction);
+    } else {
+        code_buffer_append(section, instruction);
+    }
+
+    return instruction;
+}
+
 void code_generator_defvar(const char *frame, char *varname, unsigned id){
-    printf("\nDEFVAR %s@%s_%d\n",frame,varname, id);
+    code_generator_defvar_instruction(frame, varname, id);
 }
 
 bool code_generator_need_function_frame(char* name) {
-    const char* no_frame_funcions[] = {"readString", "readInt", "readDouble", "write", "Int2Double", "Double2Int", "length", "chr"};
-    const unsigned no_frame_funcions_count = 8;
+    const char* no_frame_funcions[] = {"readString", "readInt", "readDouble", "write", "Int2Double", "Double2Int", "length", "chr", "ord", "substring"};
+    const unsigned no_frame_funcions_count = 10;
 
     for(unsigned i = 0; i < no_frame_funcions_count; i++){
         if(strcmp(name, no_frame_funcions[i]) == 0) {
@@ -151,21 +231,245 @@ bool code_generator_need_function_frame(char* name) {
 }
 
 void code_generator_buffer_print(char *text){
-    if(for_open > 0){
-        dstring_add_const_str(&print_buffer, text);
-    } else {
-        printf(text);
+    for(; *text != '\0'; text++){
+        if(*text != '\n'){
+            dstring_append(&line_buffer, *text);
+            continue;
+        }
+
+        // empty line is kept only as formatting of next instruction
+        if(line_buffer.length == 0){
+            blank_line = true;
+            continue;
+        }
+
+        instruction_t* instruction = instruction_parse(line_buffer.str);
+        if(instruction != NULL){
+            instruction->blank_line = blank_line;
+            instruction->line = source_line;
+            instruction->column = source_column;
+            code_buffer_append(section, instruction);
+        }
+
+        blank_line = false;
+        dstring_clear(&line_buffer);
+    }
+}
+
+void code_generator_source_position(token_T token){
+    source_line = token.span.line;
+    source_column = token.span.column;
+}
+
+void code_generator_line_map(const char* path){
+    line_map_path = path;
+}
+
+void code_generator_binary(const char* path){
+    binary_path = path;
+}
+
+void code_generator_compact(bool compact, const char* names_path){
+    compact_mode = compact;
+    name_map_path = names_path;
+}
+
+/**
+ * Compares variables of compact output by name (for qsort)
+*/
+static int compact_name_compare(const void *a, const void *b){
+    return strcmp(((const compact_name_t*)a)->name, ((const compact_name_t*)b)->name);
+}
+
+/**
+ * Compares name with variable of compact output (for bsearch)
+*/
+static int compact_name_find(const void *key, const void *item){
+    return strcmp((const char*)key, ((const compact_name_t*)item)->name);
+}
+
+/**
+ * Compares variables of compact output by count of uses from the highest (for qsort)
+*/
+static int compact_uses_compare(const void *a, const void *b){
+    const compact_name_t* x = *(compact_name_t* const*)a;
+    const compact_name_t* y = *(compact_name_t* const*)b;
+    if(x->uses != y->uses){
+        return (x->uses < y->uses) - (x->uses > y->uses);
     }
+    return strcmp(x->name, y->name);
 }
 
-void code_generator_buffer_transmit(){
-    printf(print_buffer.str);
-    dstring_clear(&print_buffer);
+/**
+ * Creates short name of variable (letter followed by base-36 digits, it never starts by digit)
+ * @param id id of short name
+ * @param name output buffer
+ * @param size size of output buffer
+*/
+static void code_generator_short_name(unsigned id, char* name, size_t size){
+    const char digits[] = "0123456789abcdefghijklmnopqrstuvwxyz";
+    size_t length = 0;
+
+    name[length++] = 'a' + id % 26;
+    for(id /= 26; id > 0 && length + 1 < size; id /= 36){
+        id--;
+        name[length++] = digits[id % 36];
+    }
+    name[length] = '\0';
+}
+
+/**
+ * Gives short names to variables defined in generated code and removes blank lines
+ * @param names_path file of map of short names (NULL if map is not written)
+*/
+static void code_generator_compact_names(const char* names_path){
+    unsigned count = 0;
+    for(instruction_t* i = code.head; i != NULL; i = i->next){
+        count += i->opcode == OP_DEFVAR;
+    }
+
+    compact_name_t* names = malloc((count + 1) * sizeof(compact_name_t));
+    compact_name_t** order = malloc((count + 1) * sizeof(compact_name_t*));
+    if(names == NULL || order == NULL){
+        WARNING_PRINT("Compact names can not be created.");
+        free(names);
+        free(order);
+        return;
+    }
+
+    // variables are defined by DEFVAR (parameters in temporary frame keep their name in local frame)
+    unsigned defined = 0;
+    for(instruction_t* i = code.head; i != NULL; i = i->next){
+        if(i->opcode == OP_DEFVAR){
+            names[defined].name = i->operands[0] + 3;
+            names[defined].uses = 0;
+            defined++;
+        }
+    }
+    qsort(names, defined, sizeof(compact_name_t), compact_name_compare);
+
+    // names are copied, because operands are replaced by renaming
+    count = 0;
+    for(unsigned i = 0; i < defined; i++){
+        if(count > 0 && strcmp(names[count - 1].name, names[i].name) == 0){
+            continue;
+        }
+        char* copy = malloc(strlen(names[i].name) + 1);
+        if(copy == NULL){
+            break;
+        }
+        strcpy(copy, names[i].name);
+        names[count] = names[i];
+        names[count++].name = copy;
+    }
+
+    for(instruction_t* i = code.head; i != NULL; i = i->next){
+        for(unsigned o = 0; o < i->operand_count; o++){
+            compact_name_t* name = operand_is_variable(i->operands[o]) ?
+                bsearch(i->operands[o] + 3, names, count, sizeof(compact_name_t), compact_name_find) : NULL;
+            if(name != NULL){
+                name->uses++;
+            }
+        }
+    }
+
+    for(unsigned i = 0; i < count; i++){
+        order[i] = &names[i];
+    }
+    qsort(order, count, sizeof(compact_name_t*), compact_uses_compare);
+    for(unsigned i = 0; i < count; i++){
+        order[i]->id = i;
+    }
+
+    FILE* map = names_path != NULL ? fopen(names_path, "w") : NULL;
+    if(names_path != NULL && map == NULL){
+        WARNING_PRINT("Map of compact names can not be written.");
+    }
+    for(unsigned i = 0; map != NULL && i < count; i++){
+        char short_name[16];
+        code_generator_short_name(i, short_name, sizeof(short_name));
+        fprintf(map, "%s %s\n", short_name, order[i]->name);
+    }
+    if(map != NULL){
+        fclose(map);
+    }
+
+    for(instruction_t* i = code.head; i != NULL; i = i->next){
+        i->blank_line = false;
+
+        for(unsigned o = 0; o < i->operand_count; o++){
+            compact_name_t* name = operand_is_variable(i->operands[o]) ?
+                bsearch(i->operands[o] + 3, names, count, sizeof(compact_name_t), compact_name_find) : NULL;
+            if(name == NULL){
+                continue;
+            }
+
+            char operand[24];
+            memcpy(operand, i->operands[o], 3);
+            code_generator_short_name(name->id, operand + 3, sizeof(operand) - 3);
+            instruction_set_operand(i, o, operand);
+        }
+    }
+
+    for(unsigned i = 0; i < count; i++){
+        free(names[i].name);
+    }
+    free(names);
+    free(order);
+}
+
+/**
+ * Writes generated code to binary container
+ * @param path file of container
+*/
+static void code_generator_write_binary(const char* path){
+    FILE* binary = fopen(path, "wb");
+    if(binary == NULL || !code_binary_write(&code, binary)){
+        WARNING_PRINT("Binary container can not be written.");
+    }
+    if(binary != NULL){
+        fclose(binary);
+    }
+}
+
+/**
+ * Writes source position of every instruction to map of source lines
+ * (instructions created by optimizer get position of nearest preceding instruction)
+ * @param path file of map
+*/
+static void code_generator_write_line_map(const char* path){
+    FILE* map = fopen(path, "w");
+    if(map == NULL){
+        WARNING_PRINT("Map of source lines can not be written.");
+        return;
+    }
+
+    unsigned index = 0;
+    unsigned line = 0;
+    unsigned column = 0;
+    for(instruction_t* instruction = code.head; instruction != NULL; instruction = instruction->next, index++){
+        if(instruction->line != 0){
+            line = instruction->line;
+            column = instruction->column;
+        }
+
+        if(line != 0){
+            fprintf(map, "%u %u %u\n", index, line, column);
+        }
+    }
+
+    fclose(map);
 }
 
 void code_generator_prolog(){
-    dstring_init(&print_buffer);
-	printf(".IFJcode23\n");
+    dstring_init(&line_buffer);
+    code_buffer_init(&code);
+    code_buffer_init(&functions);
+    section = &code;
+    blank_line = false;
+    loop_start = NULL;
+    source_line = 0;
+    source_column = 0;
 	code_generator_defvar("GF", "?PARAM", 1);
 	code_generator_defvar("GF", "?PARAM", 2);
 	code_generator_defvar("GF", "?RESULT", 1);
@@ -174,10 +478,14 @@ void code_generator_prolog(){
     code_generator_defvar("GF", "?READED", 2);
     code_generator_defvar("GF", "?READED", 3);
     code_generator_defvar("GF", "?INT2CHAR", 1);
+    code_generator_defvar("GF", "?COALESCE", 1);
+    code_generator_defvar("GF", "?COALESCE", 2);
+    code_generator_defvar("GF", "?ORD", 1);
+    code_generator_defvar("GF", "?SUBSTRING", 1);
+    code_generator_defvar("GF", "?SUBSTRING", 2);
+    code_generator_defvar("GF", "?SUBSTRING", 3);
     code_generator_createframe();
     code_generator_pushframe();
-    code_generator_function_ord();
-    code_generator_substring();
 }
 
 /**
@@ -198,6 +506,42 @@ void code_generator_if_end(unsigned id){
 	BUFFER_PRINT("\nLABEL $$IF_END_%u\n", id);
 }
 
+/**
+ * Appends string to operand in escaped form of IFJcode23
+ * @param operand target operand
+ * @param str appended chars
+ * @param length count of appended chars
+*/
+static void code_generator_escape_string(dstring_t* operand, const char* str, size_t length){
+    for(size_t i = 0; i < length; i++){
+        char c = str[i];
+        if((c >= 0 && c <= 32) || c == '#' || c == '\\'){
+            char escaped[8];
+            snprintf(escaped, sizeof(escaped), "\\%03d", c);
+            dstring_add_const_str(operand, escaped);
+        } else{
+            dstring_append(operand, c);
+        }
+    }
+}
+
+/**
+ * Finds position ID of parameter of generated function
+ * @param frame frame of variable
+ * @param varname name of variable
+ * @param uid unique id of variable
+ * @return position ID or -1 if variable is not parameter
+*/
+static int code_generator_param_id(const char* frame, char* varname, unsigned uid){
+    for(unsigned i = 0; frame == lf_name && i < param_count; i++){
+        if(param_slots[i].uid == uid && param_slots[i].name != NULL && strcmp(param_slots[i].name, varname) == 0){
+            return i;
+        }
+    }
+
+    return -1;
+}
+
 /**
  * Variable
  */
@@ -209,7 +553,15 @@ void code_generator_var_assign_token(token_T token){
 void code_generator_var_assign(char* var){
     
 	if(strcmp(var, "_") != 0){
-		BUFFER_PRINT("\nPOPS %s@%s_%d\n",code_generator_get_var_frame(var, true), var, code_generator_get_var_uid(var, true));
+        const char* frame = code_generator_get_var_frame(var, true);
+        unsigned uid = code_generator_get_var_uid(var, true);
+        int param_id = code_generator_param_id(frame, var, uid);
+
+        if(param_id >= 0){
+            BUFFER_PRINT("\nPOPS LF@??_%d\n", param_id);
+        } else {
+            BUFFER_PRINT("\nPOPS %s@%s_%d\n", frame, var, uid);
+        }
 	} else{
         code_generator_createframe();
         code_generator_pushframe();
@@ -224,13 +576,73 @@ void code_generator_var_declare_token(token_T token){
 }
 
 void code_generator_var_declare(char* variable){
-	code_generator_defvar(code_generator_get_var_frame(variable, false), variable, code_generator_get_var_uid(variable, false));
+	instruction_t* defvar = code_generator_defvar_instruction(code_generator_get_var_frame(variable, false), variable, code_generator_get_var_uid(variable, false));
+
+    // immutable variables (let) can be used by optimizer as invariant values
+    symtab_item_t* item = code_generator_get_var_item(variable, false);
+    if(defvar != NULL && item != NULL && !item->is_mutable){
+        defvar->is_constant = true;
+    }
+
     BUFFER_PRINT("POPS %s@%s_%d\n", code_generator_get_var_frame(variable, false), variable, code_generator_get_var_uid(variable, false));
 }
 
 void code_generator_eof(){
 	BUFFER_PRINT("\nLABEL $$EOF\n");
-    dstring_free(&print_buffer);
+
+    // main program has to end before bodies of functions
+    if(functions.head != NULL){
+        BUFFER_PRINT("EXIT int@0\n");
+        code_buffer_concat(&code, &functions);
+    }
+
+    code_optimizer_run(&code, global_symtable);
+
+    // all functions were inlined or removed
+    if(code.tail != NULL && code.tail->opcode == OP_EXIT && code.tail->prev != NULL &&
+       code.tail->prev->opcode == OP_LABEL && strcmp(code.tail->prev->operands[0], "$$EOF") == 0){
+        code_buffer_remove(&code, code.tail);
+    }
+
+    if(compact_mode){
+        code_generator_compact_names(name_map_path);
+    }
+
+    printf(".IFJcode23\n");
+    code_buffer_print(&code, stdout);
+
+    if(line_map_path != NULL){
+        code_generator_write_line_map(line_map_path);
+    }
+    if(binary_path != NULL){
+        code_generator_write_binary(binary_path);
+    }
+
+    code_generator_dispose();
+}
+
+/**
+ * Forgets parameters of generated function
+ */
+static void code_generator_params_clear(){
+    for(unsigned i = 0; i < param_count; i++){
+        free(param_slots[i].name);
+    }
+    param_count = 0;
+}
+
+void code_generator_dispose(){
+    if(line_buffer.str == NULL){
+        return;
+    }
+
+    code_buffer_dispose(&code);
+    code_buffer_dispose(&functions);
+    code_generator_params_clear();
+    free(param_slots);
+    param_slots = NULL;
+    dstring_free(&line_buffer);
+    line_buffer.str = NULL;
 }
 
 void code_generator_push(token_T token){
@@ -257,7 +669,7 @@ void code_generator_for_loop_end(unsigned id){
 
     for_open--;
     if(for_open <= 0){
-        code_generator_buffer_transmit();
+        loop_start = NULL;
     }
 }
 
@@ -270,6 +682,10 @@ void code_generator_for_loop_if(unsigned id){
 void code_generator_for_label(unsigned id){
     for_open++;
 	BUFFER_PRINT("\nLABEL $$FOR_%u\n", id);
+
+    if(for_open == 1){
+        loop_start = section->tail;
+    }
 }
 
 void code_generator_for_body(unsigned id){
@@ -280,33 +696,54 @@ void code_generator_for_body(unsigned id){
  * Value
  */
 
-void code_generator_print_value(token_T token){
+/**
+ * Creates operand of instruction with value of token
+ * @param token identifier or literal
+ * @return new string (has to be freed) or NULL on allocation error
+*/
+static char* code_generator_value_operand(token_T token){
+    dstring_t operand;
+    dstring_init(&operand);
+    char number[64];
 
     if(token.type == TOKEN_IDENTIFIER){
-        BUFFER_PRINT("%s@%s_%d",
-            code_generator_get_var_frame(token.value.string_val.str, true),
-            token.value.string_val.str,
-            code_generator_get_var_uid(token.value.string_val.str, true)
-        );
+        const char* frame = code_generator_get_var_frame(token.value.string_val.str, true);
+        unsigned uid = code_generator_get_var_uid(token.value.string_val.str, true);
+
+        // parameters are read directly from frame created by caller
+        int param_id = code_generator_param_id(frame, token.value.string_val.str, uid);
+        if(param_id >= 0){
+            snprintf(number, sizeof(number), "LF@??_%d", param_id);
+            dstring_add_const_str(&operand, number);
+        } else {
+            dstring_add_const_str(&operand, frame);
+            dstring_append(&operand, '@');
+            dstring_add_const_str(&operand, token.value.string_val.str);
+            snprintf(number, sizeof(number), "_%d", uid);
+            dstring_add_const_str(&operand, number);
+        }
     } else if (token.type == TOKEN_NIL) {
-	    BUFFER_PRINT("nil@nil");
+        dstring_add_const_str(&operand, "nil@nil");
     } else if (token.type == TOKEN_INT) {
-	    BUFFER_PRINT("int@%d",token.value.int_val);
-	} else if (token.type == TOKEN_DBL) {
-		BUFFER_PRINT("float@%a",token.value.double_val);
-	} else if (token.type == TOKEN_STRING) {
-		BUFFER_PRINT("string@");
-        int token_length = strlen(token.value.string_val.str);
-
-        for(int i = 0; i < token_length; i++){
-            char c = token.value.string_val.str[i];
-            if((c >= 0 && c <= 32) || c == '#' || c == '\\'){
-                BUFFER_PRINT("\\%03d",c);
-            } else{
-                BUFFER_PRINT("%c", c);
-            }
-        }
-	}
+        snprintf(number, sizeof(number), "int@%d", token.value.int_val);
+        dstring_add_const_str(&operand, number);
+    } else if (token.type == TOKEN_DBL) {
+        snprintf(number, sizeof(number), "float@%a", token.value.double_val);
+        dstring_add_const_str(&operand, number);
+    } else if (token.type == TOKEN_STRING) {
+        dstring_add_const_str(&operand, "string@");
+        code_generator_escape_string(&operand, token.value.string_val.str, strlen(token.value.string_val.str));
+    }
+
+    return operand.str;
+}
+
+void code_generator_print_value(token_T token){
+    char* operand = code_generator_value_operand(token);
+    if(operand != NULL){
+        BUFFER_PRINT("%s", operand);
+        free(operand);
+    }
 }
 
 /**
@@ -359,45 +796,139 @@ void code_generator_operations(token_type_T operator, bool is_int){
     }
 }
 
-void code_generator_nil_check(unsigned int id) {
-    code_generator_createframe();
-    code_generator_pushframe();
-    
+void code_generator_nil_check(unsigned int id, bool is_nil) {
     // POPS second op
-    BUFFER_PRINT("DEFVAR %s@%s_%d\n", "LF", "op", 2);
-    BUFFER_PRINT("POPS %s@%s_%d\n", "LF", "op", 2);
+    BUFFER_PRINT("\nPOPS GF@?COALESCE_2\n");
 
     // POPS first op
-    BUFFER_PRINT("DEFVAR %s@%s_%d\n", "LF", "op", 1);
-    BUFFER_PRINT("POPS %s@%s_%d\n", "LF", "op", 1);
-    // PUSHS    nil and first op
-    BUFFER_PRINT("\nPUSHS nil@nil\n");
-    BUFFER_PRINT("\nPUSHS %s@%s_%d\n", "LF", "op", 1);
+    BUFFER_PRINT("POPS GF@?COALESCE_1\n");
 
-    // result of condition first operand != nil
-    code_generator_operations(TOKEN_NEQ, false);
+    // first operand is nil literal, result is second operand
+    if (is_nil) {
+        BUFFER_PRINT("PUSHS GF@?COALESCE_2\n");
+        return;
+    }
 
-    // if first operand is nil
-    code_generator_if_header(id);
-    BUFFER_PRINT("\nPUSHS %s@%s_%d\n", "LF", "op", 1);
+    // if first operand is nil, result is second
+    BUFFER_PRINT("JUMPIFNEQ $$COALESCE_%u GF@?COALESCE_1 nil@nil\n", id);
+    BUFFER_PRINT("MOVE GF@?COALESCE_1 GF@?COALESCE_2\n");
+    BUFFER_PRINT("LABEL $$COALESCE_%u\n", id);
+    BUFFER_PRINT("PUSHS GF@?COALESCE_1\n");
+}
 
-    // else push second
-    code_generator_if_else(id);
-    BUFFER_PRINT("\nPUSHS %s@%s_%d\n","LF","op",2);
-    code_generator_if_end(id);
+/**
+ * Checks if operand is string literal
+ * @param operand operand of instruction
+ * @return bool
+*/
+static bool code_generator_is_string_literal(const char* operand){
+    return strncmp(operand, "string@", strlen("string@")) == 0;
+}
 
-    code_generator_popframe();
+/**
+ * Checks if concatenation continues chain accumulated in ?RESULT
+ * @param concat CONCAT instruction
+ * @return bool
+*/
+static bool code_generator_concat_reads_result(instruction_t* concat){
+    return strcmp(concat->operands[1], "GF@?RESULT_1") == 0 || strcmp(concat->operands[2], "GF@?RESULT_1") == 0;
+}
+
+/**
+ * Joins two string literals (escape sequences of IFJcode23 can be simply appended)
+ * @param instruction instruction, whose operand is extended
+ * @param index index of extended operand
+ * @param literal appended string literal
+*/
+static void code_generator_join_literals(instruction_t* instruction, unsigned index, const char* literal){
+    const char* first = instruction->operands[index];
+    const char* second = literal + strlen("string@");
+
+    char* joined = malloc(strlen(first) + strlen(second) + 1);
+    if(joined == NULL){
+        fprintf(stderr, "code_generator: code_generator_join_literals: allocation failed.\n");
+        return;
+    }
+
+    strcpy(joined, first);
+    strcat(joined, second);
+    instruction_set_operand(instruction, index, joined);
+    free(joined);
 }
 
 void code_generator_concats(){
-    //POPS ?PARAM_2
-    BUFFER_PRINT("\nPOPS GF@?PARAM_2\n");
+    instruction_t* second = section->tail;
+    instruction_t* first = second != NULL ? second->prev : NULL;
+
+    // right operand is accumulated chain: a + (b + c) -> CONCAT ?RESULT a ?RESULT
+    if(first != NULL && first->opcode == OP_CONCAT && strcmp(first->operands[0], "GF@?RESULT_1") == 0 &&
+       second->opcode == OP_PUSHS && strcmp(second->operands[0], "GF@?RESULT_1") == 0){
+        instruction_t* head = first;
+        while(code_generator_concat_reads_result(head) && head->prev != NULL &&
+              head->prev->opcode == OP_CONCAT && strcmp(head->prev->operands[0], "GF@?RESULT_1") == 0){
+            head = head->prev;
+        }
+
+        instruction_t* pushed = head->prev;
+        if(!code_generator_concat_reads_result(head) && pushed != NULL && pushed->opcode == OP_PUSHS &&
+           strcmp(pushed->operands[0], "GF@?RESULT_1") != 0){
+            if(code_generator_is_string_literal(pushed->operands[0]) && code_generator_is_string_literal(head->operands[1])){
+                code_generator_join_literals(pushed, 0, head->operands[1]);
+                instruction_set_operand(head, 1, pushed->operands[0]);
+            } else {
+                code_buffer_insert_after(section, first, instruction_create(OP_CONCAT, "GF@?RESULT_1", pushed->operands[0], "GF@?RESULT_1"));
+            }
+            head->blank_line = pushed->blank_line;
+            code_buffer_remove(section, pushed);
+            return;
+        }
+    }
+
+    // stack round trip is needed only when operands are computed values
+    if(first == NULL || first->opcode != OP_PUSHS || second->opcode != OP_PUSHS){
+        //POPS ?PARAM_2
+        BUFFER_PRINT("\nPOPS GF@?PARAM_2\n");
 
-    //POPS ?PARAM_1
-    BUFFER_PRINT("POPS GF@?PARAM_1\n");
+        //POPS ?PARAM_1
+        BUFFER_PRINT("POPS GF@?PARAM_1\n");
 
-    //CONCAT: ?RESULT = ?PARAM_1 + ?PARAM_2
-    BUFFER_PRINT("CONCAT GF@?RESULT_1 GF@?PARAM_1 GF@?PARAM_2\n");
+        //CONCAT: ?RESULT = ?PARAM_1 + ?PARAM_2
+        BUFFER_PRINT("CONCAT GF@?RESULT_1 GF@?PARAM_1 GF@?PARAM_2\n");
+
+        //PUSHS ?RESULT
+        BUFFER_PRINT("PUSHS GF@?RESULT_1\n");
+        return;
+    }
+
+    // adjacent literals are joined at compile time
+    if(code_generator_is_string_literal(first->operands[0]) && code_generator_is_string_literal(second->operands[0])){
+        code_generator_join_literals(first, 0, second->operands[0]);
+        code_buffer_remove(section, second);
+        return;
+    }
+
+    // chain a + b + c is accumulated in ?RESULT: CONCAT ?RESULT ?RESULT c
+    instruction_t* previous = first->prev;
+    if(strcmp(first->operands[0], "GF@?RESULT_1") == 0 && previous != NULL && previous->opcode == OP_CONCAT &&
+       strcmp(previous->operands[0], "GF@?RESULT_1") == 0){
+        if(code_generator_is_string_literal(previous->operands[2]) && code_generator_is_string_literal(second->operands[0])){
+            code_generator_join_literals(previous, 2, second->operands[0]);
+        } else {
+            code_buffer_insert_before(section, first, instruction_create(OP_CONCAT, "GF@?RESULT_1", "GF@?RESULT_1", second->operands[0]));
+        }
+        code_buffer_remove(section, second);
+        return;
+    }
+
+    instruction_t* concat = instruction_create(OP_CONCAT, "GF@?RESULT_1", first->operands[0], second->operands[0]);
+    if(concat == NULL){
+        return;
+    }
+    concat->blank_line = first->blank_line;
+
+    code_buffer_insert_before(section, first, concat);
+    code_buffer_remove(section, first);
+    code_buffer_remove(section, second);
 
     //PUSHS ?RESULT
     BUFFER_PRINT("PUSHS GF@?RESULT_1\n");
@@ -426,6 +957,8 @@ void code_generator_function_call(char* name){
     } else if((strcmp(name,"readDouble") == 0)){
         BUFFER_PRINT("READ GF@?READED_3 float\n");
         BUFFER_PRINT("PUSHS GF@?READED_3\n");
+    } else if(strcmp(name, "substring") == 0){
+        code_generator_substring();
     } else if (code_generator_need_function_frame(name)) {
         
         if (func_param_id == 0) {
@@ -477,10 +1010,81 @@ void code_generator_function_call_param_add(char* name, token_T token){
         code_generator_print_value(token);
         BUFFER_PRINT("\n");
         BUFFER_PRINT("PUSHS GF@?INT2CHAR_1\n");
+    } else if(strcmp(name, "ord") == 0){
+        char* operand = code_generator_value_operand(token);
+        if(operand != NULL){
+            code_generator_ord(operand);
+            free(operand);
+        }
+    } else if(strcmp(name, "substring") == 0 && substring_arg_count < 3){
+        // body is expanded, when all arguments are known
+        substring_args[substring_arg_count++] = code_generator_value_operand(token);
+    }
+}
+
+/**
+ * Gets change of count of values on data stack caused by instruction
+ * @param instruction examined instruction
+ * @param effect change of count of values
+ * @return false if effect of instruction is not known
+*/
+static bool code_generator_stack_effect(instruction_t* instruction, int* effect){
+    switch(instruction->opcode){
+        case OP_PUSHS:
+            *effect = 1;
+            return true;
+        case OP_POPS:
+        case OP_ADDS:
+        case OP_SUBS:
+        case OP_MULS:
+        case OP_DIVS:
+        case OP_IDIVS:
+        case OP_LTS:
+        case OP_GTS:
+        case OP_EQS:
+        case OP_ANDS:
+        case OP_ORS:
+        case OP_STRI2INTS:
+            *effect = -1;
+            return true;
+        case OP_JUMPIFEQS:
+        case OP_JUMPIFNEQS:
+            *effect = -2;
+            return true;
+        case OP_CLEARS:
+        case OP_CALL:
+        case OP_RETURN:
+        case OP_UNKNOWN:
+            return false;
+        default:
+            *effect = 0;
+            return true;
     }
 }
 
 void code_generator_int2doubles(int depth) {
+    // conversion is placed right after converted value is computed, values above it stay on stack
+    instruction_t* position = section->tail;
+    int values = 0;
+    int effect = 0;
+
+    while(values != depth && position != NULL && code_generator_stack_effect(position, &effect)){
+        values += effect;
+        position = position->prev;
+    }
+
+    if(values == depth && position != NULL){
+        // literal is converted at compile time
+        if(position->opcode == OP_PUSHS && strncmp(position->operands[0], "int@", strlen("int@")) == 0){
+            char literal[64];
+            snprintf(literal, sizeof(literal), "float@%a", (double)strtoll(position->operands[0] + strlen("int@"), NULL, 10));
+            instruction_set_operand(position, 0, literal);
+        } else {
+            code_buffer_insert_after(section, position, instruction_create(OP_INT2FLOATS, NULL, NULL, NULL));
+        }
+        return;
+    }
+
     code_generator_createframe();
     code_generator_pushframe();
 
@@ -498,71 +1102,149 @@ void code_generator_int2doubles(int depth) {
     code_generator_popframe();     
 }
 
-void code_generator_function_ord(){
-    code_generator_function_label("ord");
-
-    code_generator_defvar("LF", "length", 0);
-    printf("STRLEN LF@length_0 LF@??_0\n");
-
-    printf("JUMPIFNEQ ORD_NOT0 int@0 LF@length_0\n");
-    printf("PUSHS int@0\n");
-    code_generator_return();
+/**
+ * Gets chars of string literal (escape sequences are decoded)
+ * @param operand operand of instruction
+ * @param value decoded chars
+ * @return false if operand is not string literal with ASCII chars
+*/
+static bool code_generator_string_literal(const char* operand, dstring_t* value){
+    if(strncmp(operand, "string@", strlen("string@")) != 0){
+        return false;
+    }
 
-    printf("LABEL ORD_NOT0\n");
-    code_generator_defvar("LF", "ord_value", 0);
-    printf("STRI2INT LF@ord_value_0 LF@??_0 int@0\n");
-    printf("PUSHS LF@ord_value_0\n");
+    for(const char* c = operand + strlen("string@"); *c != '\0'; c++){
+        if(*c == '\\' && c[1] != '\0' && c[2] != '\0' && c[3] != '\0'){
+            dstring_append(value, (char)((c[1] - '0') * 100 + (c[2] - '0') * 10 + (c[3] - '0')));
+            c += 3;
+        } else if(*c < 0){
+            return false;
+        } else {
+            dstring_append(value, *c);
+        }
+    }
 
-    code_generator_function_end("ord");
+    return true;
 }
 
-void code_generator_substring(){
-    code_generator_function_label("substring");
-
-    code_generator_defvar("LF", "length", 0);
-    printf("STRLEN LF@length_0 LF@??_0\n");
-
-    code_generator_defvar("LF", "condition", 0);
-
-    printf("LT LF@condition_0 LF@??_1 int@0\n");
-    printf("JUMPIFEQ SUSTRING_nil LF@condition_0 bool@true\n");
-
-    printf("LT LF@condition_0 LF@??_2 int@0\n");
-    printf("JUMPIFEQ SUSTRING_nil LF@condition_0 bool@true\n");
-
-    printf("GT LF@condition_0 LF@??_1 LF@??_2\n");
-    printf("JUMPIFEQ SUSTRING_nil LF@condition_0 bool@true\n");
-
-    printf("LT LF@condition_0 LF@??_1 LF@length_0\n");
-    printf("JUMPIFNEQ SUSTRING_nil LF@condition_0 bool@true\n");
+/**
+ * Gets value of int literal
+ * @param operand operand of instruction
+ * @param value value of literal
+ * @return false if operand is not int literal
+*/
+static bool code_generator_int_literal(const char* operand, long long* value){
+    if(strncmp(operand, "int@", strlen("int@")) != 0){
+        return false;
+    }
 
-    printf("GT LF@condition_0 LF@??_2 LF@length_0\n");
-    printf("JUMPIFEQ SUSTRING_nil LF@condition_0 bool@true\n");
+    *value = strtoll(operand + strlen("int@"), NULL, 10);
+    return true;
+}
 
-    code_generator_defvar("LF", "result", 0);
-    code_generator_defvar("LF", "char", 0);
+void code_generator_ord(const char* operand){
+    // literal is evaluated at compile time
+    dstring_t value;
+    dstring_init(&value);
+    if(code_generator_string_literal(operand, &value)){
+        BUFFER_PRINT("\nPUSHS int@%d\n", value.length == 0 ? 0 : value.str[0]);
+        dstring_free(&value);
+        return;
+    }
+    dstring_free(&value);
 
-    printf("MOVE LF@result_0 string@\n");
+    unsigned id = builtin_id++;
 
-    printf("LABEL SUSTRING_loop\n");
+    // empty string has ord 0
+    BUFFER_PRINT("\nMOVE GF@?ORD_1 int@0\n");
+    BUFFER_PRINT("STRLEN GF@?LENGTH_1 %s\n", operand);
+    BUFFER_PRINT("JUMPIFEQ $$ORD_END_%u GF@?LENGTH_1 int@0\n", id);
+    BUFFER_PRINT("STRI2INT GF@?ORD_1 %s int@0\n", operand);
+    BUFFER_PRINT("LABEL $$ORD_END_%u\n", id);
+    BUFFER_PRINT("PUSHS GF@?ORD_1\n");
+}
 
-    printf("LT LF@condition_0 LF@??_1 LF@??_2\n");
-    printf("JUMPIFNEQ SUSTRING_loop_end LF@condition_0 bool@true\n");
+void code_generator_substring(){
+    if(substring_arg_count < 3){
+        for(unsigned i = 0; i < substring_arg_count; i++){
+            free(substring_args[i]);
+        }
+        substring_arg_count = 0;
+        return;
+    }
 
-    printf("GETCHAR LF@char_0 LF@??_0 LF@??_1\n");
-    printf("CONCAT LF@result_0 LF@result_0 LF@char_0\n");
-    printf("ADD LF@??_1 int@1 LF@??_1\n");
+    const char* string = substring_args[0];
+    const char* start = substring_args[1];
+    const char* end = substring_args[2];
+
+    long long start_value = 0;
+    long long end_value = 0;
+    bool start_known = code_generator_int_literal(start, &start_value);
+    bool end_known = code_generator_int_literal(end, &end_value);
+
+    dstring_t value;
+    dstring_init(&value);
+    bool string_known = code_generator_string_literal(string, &value);
+
+    if((start_known && start_value < 0) || (end_known && end_value < 0) ||
+       (start_known && end_known && start_value > end_value)){
+        // bounds are invalid regardless of string
+        BUFFER_PRINT("\nPUSHS nil@nil\n");
+    } else if(start_known && end_known && string_known){
+        // literals are evaluated at compile time
+        if(start_value >= (long long)value.length || end_value > (long long)value.length){
+            BUFFER_PRINT("\nPUSHS nil@nil\n");
+        } else {
+            dstring_t result;
+            dstring_init(&result);
+            dstring_add_const_str(&result, "string@");
+            code_generator_escape_string(&result, value.str + start_value, end_value - start_value);
+            BUFFER_PRINT("\nPUSHS %s\n", result.str);
+            dstring_free(&result);
+        }
+    } else {
+        unsigned id = builtin_id++;
 
-    printf("JUMP SUSTRING_loop\n");
-    printf("LABEL SUSTRING_loop_end\n");
+        // ?SUBSTRING_1 is index of copied char, ?SUBSTRING_2 is result, ?SUBSTRING_3 is condition or char
+        BUFFER_PRINT("\nMOVE GF@?SUBSTRING_1 %s\n", start);
+        BUFFER_PRINT("MOVE GF@?SUBSTRING_2 nil@nil\n");
 
-    printf("PUSHS LF@result_0\n");
-    code_generator_return();
+        if(!start_known){
+            BUFFER_PRINT("LT GF@?SUBSTRING_3 GF@?SUBSTRING_1 int@0\n");
+            BUFFER_PRINT("JUMPIFEQ $$SUBSTRING_END_%u GF@?SUBSTRING_3 bool@true\n", id);
+        }
+        if(!end_known){
+            BUFFER_PRINT("LT GF@?SUBSTRING_3 %s int@0\n", end);
+            BUFFER_PRINT("JUMPIFEQ $$SUBSTRING_END_%u GF@?SUBSTRING_3 bool@true\n", id);
+        }
+        if(!start_known || !end_known){
+            BUFFER_PRINT("GT GF@?SUBSTRING_3 GF@?SUBSTRING_1 %s\n", end);
+            BUFFER_PRINT("JUMPIFEQ $$SUBSTRING_END_%u GF@?SUBSTRING_3 bool@true\n", id);
+        }
 
-    printf("LABEL SUSTRING_nil\n");
-    printf("PUSHS nil@nil\n");
+        BUFFER_PRINT("STRLEN GF@?LENGTH_1 %s\n", string);
+        BUFFER_PRINT("LT GF@?SUBSTRING_3 GF@?SUBSTRING_1 GF@?LENGTH_1\n");
+        BUFFER_PRINT("JUMPIFNEQ $$SUBSTRING_END_%u GF@?SUBSTRING_3 bool@true\n", id);
+        BUFFER_PRINT("GT GF@?SUBSTRING_3 %s GF@?LENGTH_1\n", end);
+        BUFFER_PRINT("JUMPIFEQ $$SUBSTRING_END_%u GF@?SUBSTRING_3 bool@true\n", id);
+
+        // bounds are valid, so index reaches end exactly
+        BUFFER_PRINT("MOVE GF@?SUBSTRING_2 string@\n");
+        BUFFER_PRINT("LABEL $$SUBSTRING_LOOP_%u\n", id);
+        BUFFER_PRINT("JUMPIFEQ $$SUBSTRING_END_%u GF@?SUBSTRING_1 %s\n", id, end);
+        BUFFER_PRINT("GETCHAR GF@?SUBSTRING_3 %s GF@?SUBSTRING_1\n", string);
+        BUFFER_PRINT("CONCAT GF@?SUBSTRING_2 GF@?SUBSTRING_2 GF@?SUBSTRING_3\n");
+        BUFFER_PRINT("ADD GF@?SUBSTRING_1 GF@?SUBSTRING_1 int@1\n");
+        BUFFER_PRINT("JUMP $$SUBSTRING_LOOP_%u\n", id);
+        BUFFER_PRINT("LABEL $$SUBSTRING_END_%u\n", id);
+        BUFFER_PRINT("PUSHS GF@?SUBSTRING_2\n");
+    }
 
-    code_generator_function_end("substring");
+    dstring_free(&value);
+    for(unsigned i = 0; i < substring_arg_count; i++){
+        free(substring_args[i]);
+    }
+    substring_arg_count = 0;
 }
 
 void code_generator_function_label_token(token_T token){
@@ -570,20 +1252,42 @@ void code_generator_function_label_token(token_T token){
 }
 
 void code_generator_function_label(char* name){
-    BUFFER_PRINT("\nJUMP $$FUNCTION_END_%s\n", name);
+    section = &functions;
+    code_generator_params_clear();
     BUFFER_PRINT("\nLABEL $$FUNCTION_%s\n", name);
     code_generator_pushframe();
 }
 
 void code_generator_param_map(char *param_name, unsigned param_id){
-    code_generator_defvar(code_generator_get_var_frame(param_name, false), param_name, code_generator_get_var_uid(param_name, false));
-    BUFFER_PRINT("MOVE %s@%s_%d LF@??_%d\n", code_generator_get_var_frame(param_name, false), param_name, code_generator_get_var_uid(param_name, false), param_id);
+    // parameters are not copied to own variables, their slots in frame created by caller are used
+    if(param_id >= param_count){
+        param_slot_t* resized = realloc(param_slots, (param_id + 1) * sizeof(param_slot_t));
+        if(resized == NULL){
+            fprintf(stderr, "code_generator: code_generator_param_map: realloc failed.\n");
+            return;
+        }
+
+        param_slots = resized;
+        for(unsigned i = param_count; i <= param_id; i++){
+            param_slots[i].name = NULL;
+        }
+        param_count = param_id + 1;
+    }
+
+    free(param_slots[param_id].name);
+    param_slots[param_id].name = malloc(strlen(param_name) + 1);
+    if(param_slots[param_id].name != NULL){
+        strcpy(param_slots[param_id].name, param_name);
+    }
+    param_slots[param_id].uid = code_generator_get_var_uid(param_name, false);
 }
 
 void code_generator_function_end(char* name){
+    UNUSED(name);
     code_generator_popframe();
     BUFFER_PRINT("RETURN\n");
-    BUFFER_PRINT("\nLABEL $$FUNCTION_END_%s\n", name);
+    section = &code;
+    code_generator_params_clear();
 }
 
 void code_generator_return(){
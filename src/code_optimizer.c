@@ -0,0 +1,4243 @@
+/**
+ * @name IFJ23
+ * @file code_optimizer.c
+ * @brief Optimizations of generated IFJcode23 instructions
+ * @author Marie Kolarikova <xkolar77@stud.fit.vutbr.cz>
+ * @date 3.12.2023
+ **/
+
+#include "code_optimizer.h"
+#include "interpreter.h"
+#include <stdarg.h>
+#include <string.h>
+
+#define FUNCTION_PREFIX "$$FUNCTION_"
+#define LOOP_PREFIX "$$FOR_"
+#define LOOP_END_PREFIX "$$FOR_END_"
+#define TEMPORARY_PREFIX "LF@?"
+#define PARAMETER_PREFIX "LF@??_"
+#define LICM_PREFIX "LF@?LICM_"
+#define CSE_PREFIX "LF@?CSE_"
+#define ACCUMULATOR_PREFIX "LF@?ACC_"
+#define TAIL_PREFIX "$$TAIL_"
+#define CONDITION_VARIABLE "GF@?CONDITION"
+#define CONCAT_RESULT "GF@?RESULT_1"
+#define GLOBAL_TEMPORARY_PREFIX "GF@?"
+#define VALUE_STACK_SIZE 32
+#define SET_WORD_BITS (sizeof(unsigned) * 8)
+#define SELECTION_MAX_LENGTH 6   // maximal count of instructions matched by pattern of instruction selection
+#define SELECTION_MAX_BINDINGS 4 // count of operands bound by pattern ($0 - $3)
+
+unsigned inline_id = 0; //id of inlined call, used as suffix of renamed variables and labels
+unsigned licm_id = 0;   //id of temporary variable with value hoisted from loop
+unsigned cse_id = 0;    //id of temporary variable with value of common subexpression
+unsigned acc_id = 0;    //id of accumulator of function with eliminated linear recursion
+unsigned clone_id = 0;  //id of cloned function, used as suffix of its labels ("$c" and id)
+
+/**
+ * @brief function in generated code (JUMP over function, LABEL, body, LABEL of end)
+ */
+typedef struct function_region {
+    const char *name;     // name of function
+    instruction_t *label; // LABEL $$FUNCTION_name
+    instruction_t *end;   // first instruction after function (label of next function or NULL)
+} function_region_t;
+
+/**
+ * @brief set of operand names (pointers to operands of instructions)
+ */
+typedef struct name_set {
+    const char **names;
+    unsigned count;
+    unsigned size;
+} name_set_t;
+
+/**
+ * @brief while loop in generated code
+ */
+typedef struct loop {
+    instruction_t *label; // LABEL $$FOR_n
+    instruction_t *end;   // LABEL $$FOR_END_n
+    name_set_t written;   // variables changed inside loop
+    bool has_call;        // loop calls function (global variables can be changed)
+} loop_t;
+
+/**
+ * @brief value on data stack computed by sequence of instructions
+ */
+typedef struct stack_value {
+    instruction_t *start; // first instruction computing value
+    instruction_t *end;   // last instruction computing value
+    unsigned count;       // count of instructions computing value
+    bool invariant;       // value is same in all iterations of loop
+} stack_value_t;
+
+/**
+ * @brief recursive call in tail position (result of call is returned, optionally combined with value)
+ */
+typedef struct tail_call {
+    instruction_t *call;     // CALL of function itself
+    instruction_t *last;     // last instruction of call and its result handling
+    opcode_t operation;      // ADDS or MULS combining result with value, OP_UNKNOWN for plain tail call
+    const char *operand;     // value combined with result
+} tail_call_t;
+
+/**
+ * @brief value computed in basic block (for common subexpression elimination)
+ */
+typedef struct block_value {
+    char *key;            // canonical description of computation (NULL if unknown)
+    instruction_t *start; // first instruction computing value
+    instruction_t *end;   // last instruction computing value
+    unsigned count;       // count of instructions computing value
+    unsigned block;       // id of basic block
+    unsigned index;       // order of value in code
+} block_value_t;
+
+/**
+ * @brief list of values computed in basic blocks
+ */
+typedef struct block_values {
+    block_value_t *values;
+    unsigned count;
+    unsigned size;
+} block_values_t;
+
+/**
+ * @brief versions of variables (incremented with every change of variable)
+ */
+typedef struct versions {
+    name_set_t names;
+    unsigned *versions;
+} versions_t;
+
+/**
+ * @brief basic block of function (for liveness analysis, whole program for nilability analysis)
+ */
+typedef struct live_block {
+    instruction_t *first;     // first instruction of block
+    instruction_t *last;      // last instruction of block
+    unsigned successors[2];   // indexes of blocks following block
+    unsigned successor_count;
+    unsigned *in;             // variables live at the beginning of block
+    unsigned *out;            // variables live at the end of block
+} live_block_t;
+
+/**
+ * @brief local variables of function and their interferences (or variables of program)
+ */
+typedef struct frame_variables {
+    char **names;             // sorted names of variables defined in function
+    unsigned *order;          // indexes of variables in order of their definitions
+    unsigned count;
+    unsigned words;           // count of words in set of variables
+    unsigned *interference;   // sets of variables live at the same time as variable
+    bool all_frames;          // variables of all frames of program (local variables of function otherwise)
+    unsigned *called_reads;   // set of global variables read by functions (NULL if all are read)
+} frame_variables_t;
+
+/**
+ * @brief variables and values on data stack known to be non-nil (for nilability analysis)
+ */
+typedef struct nonnil_state {
+    unsigned *variables;             // set of variables, which are not nil
+    bool stack[VALUE_STACK_SIZE];    // values on top of data stack are not nil (values under them are unknown)
+    unsigned top;
+} nonnil_state_t;
+
+/**
+ * @brief pattern of instruction selection (sequence of instructions and its replacement)
+ *
+ * Instructions are written as in IFJcode23 with operands $0 - $3, which are bound by matching.
+ * "@A" and "@B" match binary stack operations (ADDS, LTS ...), "%A" and "%B" unary ones (NOTS, INT2FLOATS ...),
+ * in replacement they are written as their three-address instruction. DEFVAR between matched instructions
+ * is moved before replacement.
+ */
+typedef struct selection_pattern {
+    const char *match[SELECTION_MAX_LENGTH];       // matched instructions
+    const char *replacement[SELECTION_MAX_LENGTH]; // selected instructions
+    int distinct[2];  // operands, which must not be the same variable (replacement writes first before reading second)
+    int dead;         // operand of temporary variable, which must not be read after sequence (-1 if any)
+} selection_pattern_t;
+
+/**
+ * @brief constant argument passed to function by several calls (candidate of function cloning)
+ */
+typedef struct clone_candidate {
+    const char *label;     // label of called function
+    const char *argument;  // argument of call (TF@??_n)
+    const char *constant;  // value of argument
+    unsigned calls;        // count of calls passing value
+    unsigned size;         // count of instructions of function
+} clone_candidate_t;
+
+/**
+ * Checks if instruction has given opcode and first operand
+ * @param instruction checked instruction
+ * @param opcode expected opcode
+ * @param operand expected first operand
+ * @return bool
+*/
+static bool instruction_is(instruction_t *instruction, opcode_t opcode, const char *operand){
+    return instruction != NULL &&
+           instruction->opcode == opcode &&
+           instruction->operand_count > 0 &&
+           strcmp(instruction->operands[0], operand) == 0;
+}
+
+/**
+ * Checks if instruction is jump or label (first operand is label)
+ * @param instruction checked instruction
+ * @return bool
+*/
+static bool instruction_has_label(instruction_t *instruction){
+    switch(instruction->opcode){
+        case OP_LABEL:
+        case OP_JUMP:
+        case OP_JUMPIFEQ:
+        case OP_JUMPIFNEQ:
+        case OP_JUMPIFEQS:
+        case OP_JUMPIFNEQS:
+            return true;
+        default:
+            return false;
+    }
+}
+
+/**
+ * Creates operand with suffix of inlined call ("LF@x_1" -> "LF@x_1$3")
+ * @param operand original operand
+ * @param id id of inlined call
+ * @return new string (has to be freed) or NULL on allocation error
+*/
+static char *renamed_operand(const char *operand, unsigned id){
+    int   size = snprintf(NULL, 0, "%s$%u", operand, id);
+    char* data = malloc(size + 1);
+    if(data != NULL){
+        sprintf(data, "%s$%u", operand, id);
+    }
+    return data;
+}
+
+/**
+ * Renames local variables and labels of copied instruction
+ * @param instruction copied instruction
+ * @param id id of inlined call
+*/
+static void rename_instruction(instruction_t *instruction, unsigned id){
+    for(unsigned i = 0; i < instruction->operand_count; i++){
+        bool is_label = i == 0 && instruction_has_label(instruction);
+
+        if(is_label || operand_in_frame(instruction->operands[i], "LF")){
+            char *renamed = renamed_operand(instruction->operands[i], id);
+            if(renamed != NULL){
+                instruction_set_operand(instruction, i, renamed);
+                free(renamed);
+            }
+        }
+    }
+}
+
+/**
+ * Checks if instruction is label of function
+ * @param instruction checked instruction
+ * @return bool
+*/
+static bool function_label_is(instruction_t *instruction){
+    return instruction->opcode == OP_LABEL &&
+           strncmp(instruction->operands[0], FUNCTION_PREFIX, strlen(FUNCTION_PREFIX)) == 0;
+}
+
+/**
+ * Checks if instruction starts function region and fills it
+ * (functions are laid out after main program, each function ends by label of next one)
+ * @param instruction label of function
+ * @param region found region
+ * @return bool
+*/
+static bool function_region_at(instruction_t *instruction, function_region_t *region){
+    if(!function_label_is(instruction)){
+        return false;
+    }
+
+    region->name = instruction->operands[0] + strlen(FUNCTION_PREFIX);
+    region->label = instruction;
+    region->end = instruction->next;
+
+    while(region->end != NULL && !function_label_is(region->end)){
+        region->end = region->end->next;
+    }
+
+    return true;
+}
+
+/**
+ * Finds region of function by name of called label
+ * @param code generated instructions
+ * @param label label of function ($$FUNCTION_name)
+ * @param region found region
+ * @return bool
+*/
+static bool function_region_find(code_buffer_t *code, const char *label, function_region_t *region){
+    for(instruction_t *i = code->head; i != NULL; i = i->next){
+        if(instruction_is(i, OP_LABEL, label)){
+            return function_region_at(i, region);
+        }
+    }
+
+    return false;
+}
+
+/**
+ * Finds instruction, after which are defined variables of frame used by instruction
+ * (PUSHFRAME at the beginning of function or PUSHFRAME in prolog for global code)
+ * @param code generated instructions
+ * @param instruction instruction in code
+ * @return entry of frame or NULL
+*/
+static instruction_t *frame_entry(code_buffer_t *code, instruction_t *instruction){
+    for(instruction_t *i = instruction; i != NULL; i = i->prev){
+        if(function_label_is(i)){
+            return i->next;
+        }
+    }
+
+    instruction_t *entry = code->head;
+    while(entry != NULL && entry->opcode != OP_PUSHFRAME){
+        entry = entry->next;
+    }
+
+    return entry;
+}
+
+/**
+ * Finds function of region in symtable
+ * @param region region of function
+ * @param symtable global symtable (can be NULL)
+ * @return item of function or NULL
+*/
+static symtab_item_t *function_item(function_region_t *region, symtab_t *symtable){
+    if(symtable == NULL){
+        return NULL;
+    }
+
+    dstring_t name;
+    unsigned error = SYMTAB_NOT_INITIALIZED;
+    dstring_init(&name);
+    dstring_add_const_str(&name, (char *)region->name);
+    symtab_item_t *item = symtable_search(symtable, &name, &error);
+    dstring_free(&name);
+
+    if(error != SYMTAB_OK || item == NULL || item->type != function){
+        return NULL;
+    }
+
+    return item;
+}
+
+/**
+ * Finds CREATEFRAME of function call, only arguments are between it and call
+ * (CREATEFRAME (DEFVAR TF@??_n, MOVE TF@??_n value)* CALL)
+ * @param call CALL instruction
+ * @return CREATEFRAME instruction or NULL
+*/
+static instruction_t *call_frame(instruction_t *call){
+    instruction_t *createframe = call->prev;
+    while(createframe != NULL && createframe->opcode == OP_MOVE &&
+          operand_in_frame(createframe->operands[0], "TF") &&
+          instruction_is(createframe->prev, OP_DEFVAR, createframe->operands[0])){
+        createframe = createframe->prev->prev;
+    }
+
+    if(createframe == NULL || createframe->opcode != OP_CREATEFRAME){
+        return NULL;
+    }
+
+    return createframe;
+}
+
+/**
+ * Checks if function can be inlined (small, leaf, not recursive)
+ * @param region region of function
+ * @param symtable global symtable
+ * @return bool
+*/
+static bool function_is_inlinable(function_region_t *region, symtab_t *symtable){
+    symtab_item_t *item = function_item(region, symtable);
+    if(item == NULL || item->is_recursive){
+        return false;
+    }
+
+    instruction_t *pushframe = region->label->next;
+    if(pushframe == NULL || pushframe->opcode != OP_PUSHFRAME){
+        return false;
+    }
+
+    unsigned size = 0;
+    for(instruction_t *i = pushframe->next; i != region->end; i = i->next){
+        if(++size > INLINE_MAX_SIZE){
+            return false;
+        }
+
+        switch(i->opcode){
+            case OP_CALL:
+            case OP_CREATEFRAME:
+            case OP_PUSHFRAME:
+            case OP_UNKNOWN:
+                return false;
+            case OP_POPFRAME:
+                if(i->next == NULL || i->next->opcode != OP_RETURN) return false;
+                break;
+            case OP_RETURN:
+                if(i->prev->opcode != OP_POPFRAME) return false;
+                break;
+            default:
+                break;
+        }
+
+        for(unsigned j = 0; j < i->operand_count; j++){
+            if(operand_in_frame(i->operands[j], "TF")) return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Checks if there are only returns (POPFRAME, RETURN) till the end of function
+ * @param instruction first checked instruction
+ * @param end first instruction after function
+ * @return bool
+*/
+static bool only_returns_follow(instruction_t *instruction, instruction_t *end){
+    for(; instruction != end; instruction = instruction->next){
+        if(instruction->opcode != OP_POPFRAME && instruction->opcode != OP_RETURN){
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Replaces one call of function by its body
+ * @param code generated instructions
+ * @param call CALL instruction
+ * @param region region of called function
+ * @param entry instruction after which are defined variables of caller frame
+ * @return instruction following inlined code or NULL if call can not be inlined
+*/
+static instruction_t *inline_call(code_buffer_t *code, instruction_t *call, function_region_t *region, instruction_t *entry){
+    instruction_t *createframe = call_frame(call);
+    if(createframe == NULL){
+        return NULL;
+    }
+
+    unsigned id = inline_id++;
+    instruction_t *hoist = entry;
+
+    // arguments are moved to renamed parameters in caller frame
+    instruction_t *i = createframe->next;
+    code_buffer_remove(code, createframe);
+
+    while(i != call){
+        instruction_t *move = code_buffer_remove(code, i);
+        char parameter[64];
+
+        snprintf(parameter, sizeof(parameter), "LF@%s", move->operands[0] + 3);
+        char *renamed = renamed_operand(parameter, id);
+        if(renamed == NULL){
+            return NULL;
+        }
+
+        instruction_t *defvar = instruction_create(OP_DEFVAR, renamed, NULL, NULL);
+        if(defvar != NULL){
+            defvar->blank_line = true;
+            defvar->is_constant = true;
+            code_buffer_insert_after(code, hoist, defvar);
+            hoist = defvar;
+        }
+
+        instruction_set_operand(move, 0, renamed);
+        free(renamed);
+        i = move->next;
+    }
+
+    // body without PUSHFRAME, returns jump to the end of inlined code
+    char end_label[32];
+    snprintf(end_label, sizeof(end_label), "$$INLINE_END_%u", id);
+    bool end_used = false;
+
+    for(i = region->label->next->next; i != region->end; i = i->next){
+        if(i->opcode == OP_POPFRAME){
+            i = i->next;
+            if(only_returns_follow(i->next, region->end)){
+                break;
+            }
+            code_buffer_insert_before(code, call, instruction_create(OP_JUMP, end_label, NULL, NULL));
+            end_used = true;
+            continue;
+        }
+
+        instruction_t *copy = instruction_copy(i);
+        if(copy == NULL){
+            continue;
+        }
+        rename_instruction(copy, id);
+
+        if(copy->opcode == OP_DEFVAR){
+            copy->blank_line = true;
+            code_buffer_insert_after(code, hoist, copy);
+            hoist = copy;
+        } else {
+            code_buffer_insert_before(code, call, copy);
+        }
+    }
+
+    if(end_used){
+        code_buffer_insert_before(code, call, instruction_create(OP_LABEL, end_label, NULL, NULL));
+    }
+
+    return code_buffer_remove(code, call);
+}
+
+unsigned code_optimizer_inline(code_buffer_t *code, symtab_t *symtable){
+    unsigned inlined = 0;
+    function_region_t region;
+
+    for(instruction_t *i = code->head; i != NULL;){
+        if(i->opcode == OP_CALL && function_region_find(code, i->operands[0], &region) &&
+           function_is_inlinable(&region, symtable)){
+            instruction_t *entry = frame_entry(code, i);
+            instruction_t *next = entry != NULL ? inline_call(code, i, &region, entry) : NULL;
+            if(next != NULL){
+                inlined++;
+                i = next;
+                continue;
+            }
+        }
+
+        i = i->next;
+    }
+
+    return inlined;
+}
+
+void code_optimizer_remove_unused_functions(code_buffer_t *code){
+    function_region_t region;
+
+    for(instruction_t *i = code->head; i != NULL;){
+        if(!function_region_at(i, &region)){
+            i = i->next;
+            continue;
+        }
+
+        bool called = false;
+        for(instruction_t *j = code->head; j != NULL && !called; j = j->next){
+            called = instruction_is(j, OP_CALL, region.label->operands[0]);
+        }
+
+        if(called){
+            i = region.end;
+            continue;
+        }
+
+        while(i != region.end){
+            i = code_buffer_remove(code, i);
+        }
+    }
+}
+
+/**
+ * Counts instructions changing variable (DEFVAR is not counted)
+ * @param code generated instructions
+ * @param name name of variable
+ * @param write last found changing instruction
+ * @return count of changing instructions
+*/
+static unsigned variable_writes(code_buffer_t *code, const char *name, instruction_t **write){
+    unsigned count = 0;
+
+    for(instruction_t *i = code->head; i != NULL; i = i->next){
+        if(i->opcode != OP_DEFVAR && i->opcode < OP_UNKNOWN && instruction_table[i->opcode].writes_target &&
+           i->operand_count > 0 && strcmp(i->operands[0], name) == 0){
+            *write = i;
+            count++;
+        }
+    }
+
+    return count;
+}
+
+/**
+ * Initializes empty set of names
+ * @param set initialized set
+*/
+static void name_set_init(name_set_t *set){
+    set->names = NULL;
+    set->count = 0;
+    set->size = 0;
+}
+
+/**
+ * Frees set of names (names are not owned by set)
+ * @param set disposed set
+*/
+static void name_set_dispose(name_set_t *set){
+    free(set->names);
+    name_set_init(set);
+}
+
+/**
+ * Checks if name is in set
+ * @param set searched set
+ * @param name searched name
+ * @return bool
+*/
+static bool name_set_contains(name_set_t *set, const char *name){
+    for(unsigned i = 0; i < set->count; i++){
+        if(strcmp(set->names[i], name) == 0){
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * Adds name to set
+ * @param set target set
+ * @param name added name
+*/
+static void name_set_add(name_set_t *set, const char *name){
+    if(name_set_contains(set, name)){
+        return;
+    }
+
+    if(set->count == set->size){
+        unsigned size = set->size == 0 ? 16 : set->size * 2;
+        const char **names = realloc(set->names, size * sizeof(const char *));
+        if(names == NULL){
+            fprintf(stderr, "code_optimizer: name_set_add: realloc failed.\n");
+            return;
+        }
+        set->names = names;
+        set->size = size;
+    }
+
+    set->names[set->count++] = name;
+}
+
+/**
+ * Creates name of variable with given prefix and id
+ * @param buffer target buffer
+ * @param size size of buffer
+ * @param prefix prefix of name (with frame)
+ * @param id id of variable
+*/
+static void temporary_name(char *buffer, size_t size, const char *prefix, unsigned id){
+    snprintf(buffer, size, "%s%u", prefix, id);
+}
+
+/**
+ * Checks if value is computed only from values, which are same in all iterations of loop
+ * @param operand operand of instruction
+ * @param loop checked loop
+ * @param constants immutable variables
+ * @param depth count of frames pushed inside loop
+ * @return bool
+*/
+static bool operand_is_invariant(const char *operand, loop_t *loop, name_set_t *constants, unsigned depth){
+    if(depth > 0){
+        return false;
+    }
+
+    if(operand_is_constant(operand)){
+        return true;
+    }
+
+    if(!operand_in_frame(operand, "LF") && !operand_in_frame(operand, "GF")){
+        return false;
+    }
+
+    if(name_set_contains(&loop->written, operand)){
+        return false;
+    }
+
+    // global variable can be changed by called function, unless it is immutable
+    return !(operand_in_frame(operand, "GF") && loop->has_call && !name_set_contains(constants, operand));
+}
+
+/**
+ * Checks if operand is constant number different from zero
+ * @param operand operand of instruction
+ * @return bool
+*/
+static bool operand_is_nonzero_number(const char *operand){
+    if(strncmp(operand, "int@", 4) == 0){
+        return strtoll(operand + 4, NULL, 10) != 0;
+    }
+
+    if(strncmp(operand, "float@", 6) == 0){
+        return strtod(operand + 6, NULL) != 0.0;
+    }
+
+    return false;
+}
+
+/**
+ * Checks if instructions are concatenation of two values on stack
+ * (POPS ?PARAM_2, POPS ?PARAM_1, CONCAT ?RESULT_1 ?PARAM_1 ?PARAM_2, PUSHS ?RESULT_1)
+ * @param instruction first instruction
+ * @return last instruction of concatenation or NULL
+*/
+static instruction_t *concat_sequence(instruction_t *instruction){
+    instruction_t *pop_1 = instruction->next;
+    instruction_t *concat = pop_1 != NULL ? pop_1->next : NULL;
+    instruction_t *push = concat != NULL ? concat->next : NULL;
+
+    if(instruction_is(instruction, OP_POPS, "GF@?PARAM_2") &&
+       instruction_is(pop_1, OP_POPS, "GF@?PARAM_1") &&
+       instruction_is(concat, OP_CONCAT, "GF@?RESULT_1") &&
+       instruction_is(push, OP_PUSHS, "GF@?RESULT_1")){
+        return push;
+    }
+
+    return NULL;
+}
+
+/**
+ * Checks if instructions are concatenation of known values accumulated in result register
+ * (CONCAT ?RESULT_1 a b, CONCAT ?RESULT_1 ?RESULT_1 c ..., PUSHS ?RESULT_1)
+ * @param instruction first instruction
+ * @return last instruction of concatenation or NULL
+*/
+static instruction_t *concat_chain(instruction_t *instruction){
+    if(!instruction_is(instruction, OP_CONCAT, CONCAT_RESULT) ||
+       strcmp(instruction->operands[1], CONCAT_RESULT) == 0 || strcmp(instruction->operands[2], CONCAT_RESULT) == 0){
+        return NULL;
+    }
+
+    instruction_t *i = instruction->next;
+    while(instruction_is(i, OP_CONCAT, CONCAT_RESULT) &&
+          (strcmp(i->operands[1], CONCAT_RESULT) == 0) != (strcmp(i->operands[2], CONCAT_RESULT) == 0)){
+        i = i->next;
+    }
+
+    return instruction_is(i, OP_PUSHS, CONCAT_RESULT) ? i : NULL;
+}
+
+/**
+ * Checks if instructions are conversion of int on top of stack
+ * (CREATEFRAME, PUSHFRAME, INT2FLOATS, POPFRAME)
+ * @param instruction first instruction
+ * @return last instruction of conversion or NULL
+*/
+static instruction_t *int2floats_sequence(instruction_t *instruction){
+    instruction_t *pushframe = instruction->next;
+    instruction_t *convert = pushframe != NULL ? pushframe->next : NULL;
+    instruction_t *popframe = convert != NULL ? convert->next : NULL;
+
+    if(instruction->opcode == OP_CREATEFRAME &&
+       pushframe != NULL && pushframe->opcode == OP_PUSHFRAME &&
+       convert != NULL && convert->opcode == OP_INT2FLOATS &&
+       popframe != NULL && popframe->opcode == OP_POPFRAME){
+        return popframe;
+    }
+
+    return NULL;
+}
+
+/**
+ * Checks if instructions are ?? operator on two values on stack
+ * (POPS ?COALESCE_2, POPS ?COALESCE_1, JUMPIFNEQ label ?COALESCE_1 nil@nil,
+ *  MOVE ?COALESCE_1 ?COALESCE_2, LABEL label, PUSHS ?COALESCE_1)
+ * @param instruction first instruction
+ * @return last instruction of operator or NULL
+*/
+static instruction_t *coalesce_sequence(instruction_t *instruction){
+    instruction_t *pop_1 = instruction->next;
+    instruction_t *jump = pop_1 != NULL ? pop_1->next : NULL;
+    instruction_t *move = jump != NULL ? jump->next : NULL;
+    instruction_t *label = move != NULL ? move->next : NULL;
+    instruction_t *push = label != NULL ? label->next : NULL;
+
+    if(instruction_is(instruction, OP_POPS, "GF@?COALESCE_2") &&
+       instruction_is(pop_1, OP_POPS, "GF@?COALESCE_1") &&
+       jump != NULL && jump->opcode == OP_JUMPIFNEQ &&
+       instruction_is(move, OP_MOVE, "GF@?COALESCE_1") &&
+       instruction_is(label, OP_LABEL, jump->operands[0]) &&
+       instruction_is(push, OP_PUSHS, "GF@?COALESCE_1")){
+        return push;
+    }
+
+    return NULL;
+}
+
+/**
+ * Collects loops of code, inner loops are before outer loops
+ * @param code generated instructions
+ * @param count count of found loops
+ * @return array of loops (has to be freed) or NULL
+*/
+static loop_t *loops_find(code_buffer_t *code, unsigned *count){
+    loop_t *loops = NULL;
+    *count = 0;
+
+    for(instruction_t *i = code->head; i != NULL; i = i->next){
+        if(i->opcode != OP_LABEL || strncmp(i->operands[0], LOOP_END_PREFIX, strlen(LOOP_END_PREFIX)) != 0){
+            continue;
+        }
+
+        char label[128];
+        snprintf(label, sizeof(label), "%s%s", LOOP_PREFIX, i->operands[0] + strlen(LOOP_END_PREFIX));
+
+        instruction_t *start = i->prev;
+        while(start != NULL && !instruction_is(start, OP_LABEL, label)){
+            start = start->prev;
+        }
+        if(start == NULL){
+            continue;
+        }
+
+        loop_t *resized = realloc(loops, (*count + 1) * sizeof(loop_t));
+        if(resized == NULL){
+            fprintf(stderr, "code_optimizer: loops_find: realloc failed.\n");
+            break;
+        }
+        loops = resized;
+
+        loop_t *loop = &loops[(*count)++];
+        loop->label = start;
+        loop->end = i;
+        loop->has_call = false;
+        name_set_init(&loop->written);
+    }
+
+    return loops;
+}
+
+/**
+ * Collects variables changed inside loop
+ * @param loop analysed loop
+*/
+static void loop_analyse(loop_t *loop){
+    for(instruction_t *i = loop->label; i != loop->end; i = i->next){
+        if(i->opcode == OP_CALL){
+            loop->has_call = true;
+        } else if(i->opcode < OP_UNKNOWN && instruction_table[i->opcode].writes_target && i->operand_count > 0){
+            name_set_add(&loop->written, i->operands[0]);
+        }
+    }
+}
+
+/**
+ * Moves computation of value before loop and replaces it by temporary variable
+ * @param code generated instructions
+ * @param loop loop containing value
+ * @param value hoisted value
+ * @param consumer instruction using value (or NULL)
+*/
+static void hoist_value(code_buffer_t *code, loop_t *loop, stack_value_t *value, instruction_t *consumer){
+    instruction_t *position = value->end->next;
+
+    for(instruction_t *i = value->start;;){
+        instruction_t *next = i->next;
+        code_buffer_unlink(code, i);
+        code_buffer_insert_before(code, loop->label, i);
+        if(i == value->end) break;
+        i = next;
+    }
+
+    // value is already stored to temporary variable (of inner loop or common subexpression),
+    // which is not changed anywhere else, so whole assignment is moved
+    instruction_t *write;
+    if(consumer != NULL && consumer == position && consumer->opcode == OP_POPS &&
+       strncmp(consumer->operands[0], TEMPORARY_PREFIX, strlen(TEMPORARY_PREFIX)) == 0 &&
+       variable_writes(code, consumer->operands[0], &write) == 1){
+        code_buffer_unlink(code, consumer);
+        code_buffer_insert_before(code, loop->label, consumer);
+        return;
+    }
+
+    char name[32];
+    temporary_name(name, sizeof(name), LICM_PREFIX, licm_id++);
+
+    instruction_t *defvar = instruction_create(OP_DEFVAR, name, NULL, NULL);
+    if(defvar != NULL){
+        defvar->blank_line = true;
+        code_buffer_insert_after(code, frame_entry(code, loop->label), defvar);
+    }
+
+    code_buffer_insert_before(code, loop->label, instruction_create(OP_POPS, name, NULL, NULL));
+    code_buffer_insert_before(code, position, instruction_create(OP_PUSHS, name, NULL, NULL));
+}
+
+/**
+ * Checks if value is worth hoisting
+ * @param value value on stack
+ * @return bool
+*/
+static bool value_is_hoistable(stack_value_t *value){
+    return value->invariant && value->start != NULL && value->count > 1;
+}
+
+/**
+ * Hoists all invariant values on simulated stack and clears it
+ * @param code generated instructions
+ * @param loop processed loop
+ * @param stack simulated stack
+ * @param top count of values on stack
+*/
+static void values_flush(code_buffer_t *code, loop_t *loop, stack_value_t *stack, unsigned *top){
+    for(unsigned i = 0; i < *top; i++){
+        if(value_is_hoistable(&stack[i])){
+            hoist_value(code, loop, &stack[i], NULL);
+        }
+    }
+
+    *top = 0;
+}
+
+/**
+ * Pushes value to simulated stack
+ * @param code generated instructions
+ * @param loop processed loop
+ * @param stack simulated stack
+ * @param top count of values on stack
+ * @param value pushed value
+*/
+static void values_push(code_buffer_t *code, loop_t *loop, stack_value_t *stack, unsigned *top, stack_value_t value){
+    if(*top == VALUE_STACK_SIZE){
+        values_flush(code, loop, stack, top);
+    }
+
+    stack[(*top)++] = value;
+}
+
+/**
+ * Hoists invariant computations from loop
+ * @param code generated instructions
+ * @param loop processed loop
+ * @param constants immutable variables
+*/
+static void loop_hoist_invariants(code_buffer_t *code, loop_t *loop, name_set_t *constants){
+    stack_value_t stack[VALUE_STACK_SIZE];
+    unsigned top = 0;
+    unsigned depth = 0;
+
+    for(instruction_t *i = loop->label->next; i != loop->end;){
+        instruction_t *next = i->next;
+        instruction_t *end = i;
+        unsigned operands = 0; // count of values used by operation
+        bool safe = true;      // operation can not end with runtime error
+
+        switch(i->opcode){
+            case OP_PUSHS:
+                values_push(code, loop, stack, &top, (stack_value_t){i, i, 1,
+                    operand_is_invariant(i->operands[0], loop, constants, depth)});
+                i = next;
+                continue;
+            case OP_STRLEN:
+                if(instruction_is(next, OP_PUSHS, i->operands[0])){
+                    values_push(code, loop, stack, &top, (stack_value_t){i, next, 2,
+                        operand_is_invariant(i->operands[1], loop, constants, depth)});
+                    i = next->next;
+                    continue;
+                }
+                break;
+            case OP_CONCAT:
+                if((end = concat_chain(i)) != NULL){
+                    stack_value_t chain = {i, end, 0, depth == 0};
+                    for(instruction_t *j = i; j != end; j = j->next){
+                        for(unsigned k = 1; k < MAX_OPERANDS; k++){
+                            chain.invariant = chain.invariant && (strcmp(j->operands[k], CONCAT_RESULT) == 0 ||
+                                              operand_is_invariant(j->operands[k], loop, constants, depth));
+                        }
+                        chain.count++;
+                    }
+                    chain.count++;
+                    values_push(code, loop, stack, &top, chain);
+                    i = end->next;
+                    continue;
+                }
+                break;
+            case OP_POPS:
+                if((end = concat_sequence(i)) != NULL || (end = coalesce_sequence(i)) != NULL){
+                    operands = 2;
+                } else if(top > 0){
+                    top--;
+                    if(value_is_hoistable(&stack[top])){
+                        hoist_value(code, loop, &stack[top], i);
+                    }
+                    i = next;
+                    continue;
+                }
+                break;
+            case OP_CREATEFRAME:
+                if((end = int2floats_sequence(i)) != NULL){
+                    operands = 1;
+                }
+                break;
+            case OP_ADDS:
+            case OP_SUBS:
+            case OP_MULS:
+            case OP_LTS:
+            case OP_GTS:
+            case OP_EQS:
+            case OP_ANDS:
+            case OP_ORS:
+                operands = 2;
+                break;
+            case OP_DIVS:
+            case OP_IDIVS:
+                operands = 2;
+                safe = top > 0 && stack[top - 1].count == 1 && stack[top - 1].start != NULL &&
+                       operand_is_nonzero_number(stack[top - 1].start->operands[0]);
+                break;
+            case OP_NOTS:
+            case OP_INT2FLOATS:
+                operands = 1;
+                break;
+            default:
+                break;
+        }
+
+        if(operands == 0 || top < operands){
+            // unknown instruction ends all computations on stack
+            values_flush(code, loop, stack, &top);
+            if(i->opcode == OP_PUSHFRAME){
+                depth++;
+            } else if(i->opcode == OP_POPFRAME && depth > 0){
+                depth--;
+            }
+            i = next;
+            continue;
+        }
+
+        next = end->next;
+        stack_value_t result = {stack[top - operands].start, end, 0, safe && depth == 0};
+
+        for(unsigned j = top - operands; j < top; j++){
+            instruction_t *following = j + 1 < top ? stack[j + 1].start : i;
+            result.invariant = result.invariant && stack[j].invariant && stack[j].end->next == following;
+            result.count += stack[j].count;
+        }
+        for(instruction_t *j = i; j != end->next; j = j->next){
+            result.count++;
+        }
+
+        if(!result.invariant){
+            for(unsigned j = top - operands; j < top; j++){
+                if(value_is_hoistable(&stack[j])){
+                    hoist_value(code, loop, &stack[j], NULL);
+                }
+            }
+            result.start = i;
+        }
+
+        top -= operands;
+        values_push(code, loop, stack, &top, result);
+        i = next;
+    }
+
+    values_flush(code, loop, stack, &top);
+}
+
+void code_optimizer_hoist_invariants(code_buffer_t *code){
+    name_set_t constants;
+    name_set_init(&constants);
+
+    for(instruction_t *i = code->head; i != NULL; i = i->next){
+        if(i->opcode == OP_DEFVAR && i->is_constant){
+            name_set_add(&constants, i->operands[0]);
+        }
+    }
+
+    unsigned count;
+    loop_t *loops = loops_find(code, &count);
+
+    for(unsigned i = 0; i < count; i++){
+        loop_analyse(&loops[i]);
+        loop_hoist_invariants(code, &loops[i], &constants);
+        name_set_dispose(&loops[i].written);
+    }
+
+    free(loops);
+    name_set_dispose(&constants);
+}
+
+/**
+ * Checks if parameter is changed in function
+ * @param position instruction in function
+ * @param parameter checked parameter (LF@??_n)
+ * @return bool
+*/
+static bool parameter_is_written(instruction_t *position, const char *parameter){
+    instruction_t *start = position;
+    while(start->prev != NULL && !function_label_is(start)){
+        start = start->prev;
+    }
+
+    for(instruction_t *i = start; i != NULL && (i == start || !function_label_is(i)); i = i->next){
+        if(i->opcode < OP_UNKNOWN && instruction_table[i->opcode].writes_target &&
+           i->operand_count > 0 && strcmp(i->operands[0], parameter) == 0){
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * Checks if variable can be replaced by source of its only assignment
+ * @param code generated instructions
+ * @param source assigned value
+ * @param variable replaced variable
+ * @param position assignment of variable
+ * @return bool
+*/
+static bool copy_source_is_valid(code_buffer_t *code, const char *source, const char *variable, instruction_t *position){
+    if(operand_is_constant(source)){
+        return true;
+    }
+
+    if(strcmp(source, variable) == 0 || operand_in_frame(source, "TF") || !operand_is_variable(source)){
+        return false;
+    }
+
+    // internal registers of code generator (GF@?...) are valid only right after they are set
+    if(strncmp(source, "GF@?", 4) == 0){
+        return false;
+    }
+
+    // parameters are defined by caller, only assignments in body of their function change them
+    if(strncmp(source, PARAMETER_PREFIX, strlen(PARAMETER_PREFIX)) == 0 && strchr(source, '$') == NULL){
+        return !operand_in_frame(variable, "GF") && !parameter_is_written(position, source);
+    }
+
+    // global variable can be used in functions, where local frame of source is not visible
+    if(operand_in_frame(variable, "GF") && !operand_in_frame(source, "GF")){
+        return false;
+    }
+
+    instruction_t *write;
+    return variable_writes(code, source, &write) == 1;
+}
+
+/**
+ * Replaces reads of variable by another operand
+ * @param code generated instructions
+ * @param variable replaced variable
+ * @param value new operand
+*/
+static void variable_replace(code_buffer_t *code, const char *variable, const char *value){
+    for(instruction_t *i = code->head; i != NULL; i = i->next){
+        bool writes = i->opcode == OP_DEFVAR || (i->opcode < OP_UNKNOWN && instruction_table[i->opcode].writes_target);
+
+        for(unsigned j = writes ? 1 : 0; j < i->operand_count; j++){
+            if(strcmp(i->operands[j], variable) == 0){
+                instruction_set_operand(i, j, value);
+            }
+        }
+    }
+}
+
+/**
+ * Replaces one immutable variable by its value
+ * @param code generated instructions
+ * @param defvar definition of variable
+ * @return true if variable was removed
+*/
+static bool propagate_variable(code_buffer_t *code, instruction_t *defvar){
+    instruction_t *write;
+    if(variable_writes(code, defvar->operands[0], &write) != 1){
+        return false;
+    }
+
+    instruction_t *push = NULL;
+    const char *source;
+
+    // definition can be placed between value and its assignment
+    instruction_t *previous = write->prev;
+    while(previous != NULL && previous->opcode == OP_DEFVAR){
+        previous = previous->prev;
+    }
+
+    if(write->opcode == OP_POPS && previous != NULL && previous->opcode == OP_PUSHS){
+        push = previous;
+        source = push->operands[0];
+    } else if(write->opcode == OP_MOVE){
+        source = write->operands[1];
+    } else {
+        return false;
+    }
+
+    if(!copy_source_is_valid(code, source, defvar->operands[0], write)){
+        return false;
+    }
+
+    char *value = malloc(strlen(source) + 1);
+    if(value == NULL){
+        return false;
+    }
+    strcpy(value, source);
+
+    if(push != NULL){
+        code_buffer_remove(code, push);
+    }
+    code_buffer_remove(code, write);
+
+    variable_replace(code, defvar->operands[0], value);
+    code_buffer_remove(code, defvar);
+    free(value);
+
+    return true;
+}
+
+void code_optimizer_propagate_copies(code_buffer_t *code){
+    // definitions are collected first, propagation removes other instructions around them
+    unsigned count = 0;
+    for(instruction_t *i = code->head; i != NULL; i = i->next){
+        count += i->opcode == OP_DEFVAR && i->is_constant;
+    }
+    if(count == 0){
+        return;
+    }
+
+    instruction_t **defvars = malloc(count * sizeof(instruction_t *));
+    if(defvars == NULL){
+        fprintf(stderr, "code_optimizer: code_optimizer_propagate_copies: allocation failed.\n");
+        return;
+    }
+
+    count = 0;
+    for(instruction_t *i = code->head; i != NULL; i = i->next){
+        if(i->opcode == OP_DEFVAR && i->is_constant){
+            defvars[count++] = i;
+        }
+    }
+
+    // chains of copies (let b = a; let c = b) need more passes
+    bool changed = true;
+    while(changed){
+        changed = false;
+
+        for(unsigned i = 0; i < count; i++){
+            if(defvars[i] != NULL && propagate_variable(code, defvars[i])){
+                defvars[i] = NULL;
+                changed = true;
+            }
+        }
+    }
+
+    free(defvars);
+}
+
+/**
+ * Finds label in code
+ * @param code generated instructions
+ * @param label name of label
+ * @return LABEL instruction or NULL
+*/
+static instruction_t *label_find(code_buffer_t *code, const char *label){
+    for(instruction_t *i = code->head; i != NULL; i = i->next){
+        if(instruction_is(i, OP_LABEL, label)){
+            return i;
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * Skips labels and follows unconditional jumps
+ * @param code generated instructions
+ * @param instruction first instruction
+ * @return first instruction, which is not label or jump, or NULL
+*/
+static instruction_t *tail_follow(code_buffer_t *code, instruction_t *instruction){
+    for(unsigned steps = 0; instruction != NULL && steps < TAIL_FOLLOW_LIMIT; steps++){
+        if(instruction->opcode == OP_LABEL){
+            instruction = instruction->next;
+        } else if(instruction->opcode == OP_JUMP){
+            instruction = label_find(code, instruction->operands[0]);
+        } else {
+            return instruction;
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * Checks if instruction returns from function (POPFRAME, RETURN)
+ * @param instruction checked instruction
+ * @return bool
+*/
+static bool instruction_returns(instruction_t *instruction){
+    return instruction != NULL && instruction->opcode == OP_POPFRAME &&
+           instruction->next != NULL && instruction->next->opcode == OP_RETURN;
+}
+
+/**
+ * Checks if value of variable is returned right after instruction
+ * @param code generated instructions
+ * @param instruction first instruction
+ * @param variable returned variable
+ * @return bool
+*/
+static bool variable_returned(code_buffer_t *code, instruction_t *instruction, const char *variable){
+    instruction_t *push = tail_follow(code, instruction);
+    return instruction_is(push, OP_PUSHS, variable) && instruction_returns(push->next);
+}
+
+/**
+ * Checks if recursive call is in tail position
+ * @param code generated instructions
+ * @param call CALL of function itself
+ * @param is_void function does not return value
+ * @param tail found tail call
+ * @return bool
+*/
+static bool tail_call_match(code_buffer_t *code, instruction_t *call, bool is_void, tail_call_t *tail){
+    tail->call = call;
+    tail->last = call;
+    tail->operation = OP_UNKNOWN;
+    tail->operand = NULL;
+
+    if(call_frame(call) == NULL){
+        return false;
+    }
+
+    if(is_void){
+        return instruction_returns(tail_follow(code, call->next));
+    }
+
+    // result of call is stored to variable
+    instruction_t *pop = call->next;
+    if(pop != NULL && pop->opcode == OP_DEFVAR && instruction_is(pop->next, OP_POPS, pop->operands[0])){
+        pop = pop->next;
+    }
+    if(pop == NULL || pop->opcode != OP_POPS || !operand_in_frame(pop->operands[0], "LF")){
+        return false;
+    }
+
+    const char *result = pop->operands[0];
+    tail->last = pop;
+
+    if(variable_returned(code, pop->next, result)){
+        return true;
+    }
+
+    // result is combined with other value: PUSHS a, PUSHS b, ADDS/MULS
+    instruction_t *first = pop->next;
+    instruction_t *second = first != NULL ? first->next : NULL;
+    instruction_t *operation = second != NULL ? second->next : NULL;
+
+    if(first == NULL || first->opcode != OP_PUSHS || second == NULL || second->opcode != OP_PUSHS ||
+       operation == NULL || (operation->opcode != OP_ADDS && operation->opcode != OP_MULS)){
+        return false;
+    }
+
+    bool first_is_result = strcmp(first->operands[0], result) == 0;
+    bool second_is_result = strcmp(second->operands[0], result) == 0;
+    if(first_is_result == second_is_result){
+        return false;
+    }
+
+    tail->operation = operation->opcode;
+    tail->operand = first_is_result ? second->operands[0] : first->operands[0];
+    tail->last = operation;
+
+    // operand is read before recursive call, so the call must not change it (global variables can be written by it)
+    if(!operand_is_constant(tail->operand) && !operand_in_frame(tail->operand, "LF")){
+        return false;
+    }
+
+    if(instruction_returns(tail_follow(code, operation->next))){
+        return true;
+    }
+
+    instruction_t *store = operation->next;
+    if(store != NULL && store->opcode == OP_POPS && variable_returned(code, store->next, store->operands[0])){
+        tail->last = store;
+        return true;
+    }
+
+    return false;
+}
+
+/**
+ * Moves definitions of local variables to the beginning of function
+ * @param code generated instructions
+ * @param region region of function
+ * @return last definition (or PUSHFRAME)
+*/
+static instruction_t *function_hoist_definitions(code_buffer_t *code, function_region_t *region){
+    instruction_t *hoist = region->label->next;
+
+    while(hoist->next != region->end && hoist->next->opcode == OP_DEFVAR){
+        hoist = hoist->next;
+    }
+
+    for(instruction_t *i = hoist->next; i != region->end;){
+        instruction_t *next = i->next;
+
+        if(i->opcode == OP_DEFVAR && operand_in_frame(i->operands[0], "LF")){
+            code_buffer_unlink(code, i);
+            code_buffer_insert_after(code, hoist, i);
+            hoist = i;
+        }
+
+        i = next;
+    }
+
+    return hoist;
+}
+
+/**
+ * Replaces recursive call by assignment of parameters and jump to the beginning of function
+ * @param code generated instructions
+ * @param tail replaced call
+ * @param label label after definitions of variables
+ * @param accumulator variable with combined results (for calls with operation)
+*/
+static void tail_call_replace(code_buffer_t *code, tail_call_t *tail, const char *label, const char *accumulator){
+    instruction_t *createframe = call_frame(tail->call);
+
+    if(tail->operation != OP_UNKNOWN){
+        code_buffer_insert_before(code, createframe, instruction_create(OP_PUSHS, accumulator, NULL, NULL));
+        code_buffer_insert_before(code, createframe, instruction_create(OP_PUSHS, tail->operand, NULL, NULL));
+        code_buffer_insert_before(code, createframe, instruction_create(tail->operation, NULL, NULL, NULL));
+        code_buffer_insert_before(code, createframe, instruction_create(OP_POPS, accumulator, NULL, NULL));
+    }
+
+    // arguments can read parameters, which are assigned by previous argument
+    bool parallel = false;
+    for(instruction_t *i = createframe->next; i != tail->call; i = i->next){
+        if(i->opcode == OP_MOVE && strncmp(i->operands[1], PARAMETER_PREFIX, strlen(PARAMETER_PREFIX)) == 0 &&
+           strcmp(i->operands[1] + 3, i->operands[0] + 3) != 0){
+            parallel = true;
+        }
+    }
+
+    for(instruction_t *i = createframe->next; i != tail->call; i = i->next){
+        if(i->opcode != OP_MOVE){
+            continue;
+        }
+
+        if(parallel){
+            code_buffer_insert_before(code, createframe, instruction_create(OP_PUSHS, i->operands[1], NULL, NULL));
+        } else if(strcmp(i->operands[0] + 3, i->operands[1] + 3) != 0 || !operand_in_frame(i->operands[1], "LF")){
+            instruction_t *move = instruction_create(OP_MOVE, i->operands[0], i->operands[1], NULL);
+            if(move != NULL){
+                move->operands[0][0] = 'L';
+            }
+            code_buffer_insert_before(code, createframe, move);
+        }
+    }
+
+    // values on stack are assigned in reverse order
+    for(instruction_t *i = tail->call->prev; parallel && i != createframe; i = i->prev){
+        if(i->opcode == OP_MOVE){
+            instruction_t *pop = instruction_create(OP_POPS, i->operands[0], NULL, NULL);
+            if(pop != NULL){
+                pop->operands[0][0] = 'L';
+            }
+            code_buffer_insert_before(code, createframe, pop);
+        }
+    }
+
+    code_buffer_insert_before(code, createframe, instruction_create(OP_JUMP, label, NULL, NULL));
+
+    instruction_t *end = tail->last->next;
+    for(instruction_t *i = createframe; i != end;){
+        i = code_buffer_remove(code, i);
+    }
+}
+
+/**
+ * Eliminates recursive tail calls of one function
+ * @param code generated instructions
+ * @param region region of function
+ * @param item function in symtable
+*/
+static void function_eliminate_tail_calls(code_buffer_t *code, function_region_t *region, symtab_item_t *item){
+    unsigned count = 0;
+    for(instruction_t *i = region->label; i != region->end; i = i->next){
+        count += instruction_is(i, OP_CALL, region->label->operands[0]);
+    }
+    if(count == 0){
+        return;
+    }
+
+    tail_call_t *tails = malloc(count * sizeof(tail_call_t));
+    if(tails == NULL){
+        fprintf(stderr, "code_optimizer: function_eliminate_tail_calls: allocation failed.\n");
+        return;
+    }
+
+    // combined results need one associative operation on integers
+    bool is_void = item->return_type == nil;
+    opcode_t operation = OP_UNKNOWN;
+    bool valid = true;
+    count = 0;
+
+    for(instruction_t *i = region->label; i != region->end; i = i->next){
+        if(!instruction_is(i, OP_CALL, region->label->operands[0]) || !tail_call_match(code, i, is_void, &tails[count])){
+            continue;
+        }
+
+        if(tails[count].operation != OP_UNKNOWN){
+            valid = valid && item->return_type == integer && !item->is_nillable &&
+                    (operation == OP_UNKNOWN || operation == tails[count].operation);
+            operation = tails[count].operation;
+        }
+        count++;
+    }
+
+    if(count == 0 || !valid){
+        free(tails);
+        return;
+    }
+
+    char label[128];
+    snprintf(label, sizeof(label), "%s%s", TAIL_PREFIX, region->name);
+
+    instruction_t *definitions = function_hoist_definitions(code, region);
+    code_buffer_insert_after(code, definitions, instruction_create(OP_LABEL, label, NULL, NULL));
+
+    char accumulator[32];
+    if(operation != OP_UNKNOWN){
+        temporary_name(accumulator, sizeof(accumulator), ACCUMULATOR_PREFIX, acc_id++);
+
+        instruction_t *defvar = instruction_create(OP_DEFVAR, accumulator, NULL, NULL);
+        if(defvar != NULL){
+            defvar->blank_line = true;
+        }
+        code_buffer_insert_after(code, definitions, defvar);
+        code_buffer_insert_after(code, defvar, instruction_create(OP_MOVE, accumulator,
+                                 operation == OP_ADDS ? "int@0" : "int@1", NULL));
+    }
+
+    for(unsigned i = 0; i < count; i++){
+        tail_call_replace(code, &tails[i], label, accumulator);
+    }
+
+    // other returns combine their result with accumulator
+    if(operation != OP_UNKNOWN){
+        for(instruction_t *i = region->label; i != region->end; i = i->next){
+            if(instruction_returns(i)){
+                code_buffer_insert_before(code, i, instruction_create(OP_PUSHS, accumulator, NULL, NULL));
+                code_buffer_insert_before(code, i, instruction_create(operation, NULL, NULL, NULL));
+            }
+        }
+    }
+
+    free(tails);
+}
+
+void code_optimizer_eliminate_tail_calls(code_buffer_t *code, symtab_t *symtable){
+    function_region_t region;
+
+    for(instruction_t *i = code->head; i != NULL;){
+        if(!function_region_at(i, &region)){
+            i = i->next;
+            continue;
+        }
+
+        symtab_item_t *item = function_item(&region, symtable);
+        if(item != NULL && region.label->next != NULL && region.label->next->opcode == OP_PUSHFRAME){
+            function_eliminate_tail_calls(code, &region, item);
+        }
+
+        i = region.end;
+    }
+}
+
+/**
+ * Creates formatted string in newly allocated memory
+ * @param fmt format of string
+ * @param ... other parameters are inserted positionally into the format
+ * @return new string (has to be freed) or NULL on allocation error
+*/
+static char *key_create(const char *fmt, ...){
+    va_list args;
+    va_start(args, fmt);
+    int size = vsnprintf(NULL, 0, fmt, args);
+    va_end(args);
+
+    char *key = malloc(size + 1);
+    if(key == NULL){
+        fprintf(stderr, "code_optimizer: key_create: allocation failed.\n");
+        return NULL;
+    }
+
+    va_start(args, fmt);
+    vsprintf(key, fmt, args);
+    va_end(args);
+
+    return key;
+}
+
+/**
+ * Gets current version of variable
+ * @param versions table of versions
+ * @param name name of variable
+ * @return version of variable
+*/
+static unsigned version_get(versions_t *versions, const char *name){
+    for(unsigned i = 0; i < versions->names.count; i++){
+        if(strcmp(versions->names.names[i], name) == 0){
+            return versions->versions[i];
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * Increments version of changed variable
+ * @param versions table of versions
+ * @param name name of variable
+*/
+static void version_increment(versions_t *versions, const char *name){
+    for(unsigned i = 0; i < versions->names.count; i++){
+        if(strcmp(versions->names.names[i], name) == 0){
+            versions->versions[i]++;
+            return;
+        }
+    }
+
+    name_set_add(&versions->names, name);
+    unsigned *resized = realloc(versions->versions, versions->names.size * sizeof(unsigned));
+    if(resized == NULL){
+        fprintf(stderr, "code_optimizer: version_increment: realloc failed.\n");
+        return;
+    }
+    versions->versions = resized;
+    versions->versions[versions->names.count - 1] = 1;
+}
+
+/**
+ * Adds copy of value to list of computed values
+ * @param list list of values
+ * @param value added value
+*/
+static void block_values_add(block_values_t *list, block_value_t *value){
+    if(list->count == list->size){
+        unsigned size = list->size == 0 ? 64 : list->size * 2;
+        block_value_t *values = realloc(list->values, size * sizeof(block_value_t));
+        if(values == NULL){
+            fprintf(stderr, "code_optimizer: block_values_add: realloc failed.\n");
+            return;
+        }
+        list->values = values;
+        list->size = size;
+    }
+
+    block_value_t *copy = &list->values[list->count];
+    *copy = *value;
+    copy->index = list->count;
+    copy->key = key_create("%s", value->key);
+    if(copy->key != NULL){
+        list->count++;
+    }
+}
+
+/**
+ * Frees values of simulated stack
+ * @param stack simulated stack
+ * @param top count of values on stack
+*/
+static void block_stack_clear(block_value_t *stack, unsigned *top){
+    for(unsigned i = 0; i < *top; i++){
+        free(stack[i].key);
+    }
+
+    *top = 0;
+}
+
+/**
+ * Checks if operation gives same result for swapped operands
+ * @param opcode operation
+ * @return bool
+*/
+static bool operation_is_commutative(opcode_t opcode){
+    return opcode == OP_ADDS || opcode == OP_MULS || opcode == OP_EQS || opcode == OP_ANDS || opcode == OP_ORS;
+}
+
+/**
+ * Applies operation to values on top of simulated stack and records result
+ * @param list list of computed values
+ * @param stack simulated stack
+ * @param top count of values on stack
+ * @param operands count of values used by operation
+ * @param name name of operation in key
+ * @param commutative operands can be swapped
+ * @param start first instruction of operation
+ * @param end last instruction of operation
+ * @param block id of basic block
+*/
+static void block_operation(block_values_t *list, block_value_t *stack, unsigned *top, unsigned operands,
+                            const char *name, bool commutative, instruction_t *start, instruction_t *end,
+                            unsigned block){
+    block_value_t result = {NULL, start, end, 0, block, 0};
+
+    for(instruction_t *i = start; i != end->next; i = i->next){
+        result.count++;
+    }
+
+    if(*top < operands){
+        block_stack_clear(stack, top);
+        stack[(*top)++] = result;
+        return;
+    }
+
+    block_value_t *first = &stack[*top - operands];
+    bool known = true;
+
+    for(unsigned j = *top - operands; j < *top; j++){
+        instruction_t *following = j + 1 < *top ? stack[j + 1].start : start;
+        known = known && stack[j].key != NULL && stack[j].end->next == following;
+        result.count += stack[j].count;
+    }
+
+    if(known){
+        result.start = first->start;
+
+        if(operands == 1){
+            result.key = key_create("(%s %s)", name, first->key);
+        } else {
+            const char *a = first->key;
+            const char *b = stack[*top - 1].key;
+            if(commutative && strcmp(a, b) > 0){
+                const char *swap = a;
+                a = b;
+                b = swap;
+            }
+            result.key = key_create("(%s %s %s)", name, a, b);
+        }
+
+        if(result.key != NULL){
+            block_values_add(list, &result);
+        }
+    }
+
+    for(unsigned j = *top - operands; j < *top; j++){
+        free(stack[j].key);
+    }
+    *top -= operands;
+    stack[(*top)++] = result;
+}
+
+/**
+ * Creates canonical description of concatenation chain
+ * @param start first CONCAT of chain
+ * @param end PUSHS of result
+ * @param versions current versions of variables
+ * @return new string (has to be freed) or NULL if some operand is not constant or variable
+*/
+static char *concat_chain_key(instruction_t *start, instruction_t *end, versions_t *versions){
+    char *key = key_create("(CONCAT");
+
+    for(instruction_t *i = start; i != end && key != NULL; i = i->next){
+        // accumulated result is always one operand of following concatenation
+        for(unsigned j = 1; j < MAX_OPERANDS && key != NULL; j++){
+            const char *operand = i->operands[j];
+            char *extended = NULL;
+
+            if(strcmp(operand, CONCAT_RESULT) == 0){
+                extended = key_create("%s %s", key, j == 1 ? "<" : ">");
+            } else if(operand_is_constant(operand)){
+                extended = key_create("%s %s", key, operand);
+            } else if(operand_is_variable(operand)){
+                extended = key_create("%s %s#%u", key, operand, version_get(versions, operand));
+            }
+
+            free(key);
+            key = extended;
+        }
+    }
+
+    char *closed = key != NULL ? key_create("%s)", key) : NULL;
+    free(key);
+    return closed;
+}
+
+/**
+ * Collects values computed on data stack in basic blocks
+ * @param code generated instructions
+ * @param list list of computed values
+*/
+static void block_values_collect(code_buffer_t *code, block_values_t *list){
+    block_value_t stack[VALUE_STACK_SIZE];
+    unsigned top = 0;
+    unsigned block = 0;
+
+    versions_t versions;
+    name_set_init(&versions.names);
+    versions.versions = NULL;
+
+    for(instruction_t *i = code->head; i != NULL;){
+        instruction_t *next = i->next;
+        instruction_t *end = NULL;
+
+        if(top == VALUE_STACK_SIZE){
+            block_stack_clear(stack, &top);
+        }
+
+        switch(i->opcode){
+            case OP_PUSHS: {
+                block_value_t leaf = {NULL, i, i, 1, block, 0};
+                if(operand_is_constant(i->operands[0])){
+                    leaf.key = key_create("%s", i->operands[0]);
+                } else if(operand_is_variable(i->operands[0])){
+                    leaf.key = key_create("%s#%u", i->operands[0], version_get(&versions, i->operands[0]));
+                }
+                stack[top++] = leaf;
+                i = next;
+                continue;
+            }
+            case OP_STRLEN:
+                if(instruction_is(next, OP_PUSHS, i->operands[0]) && operand_is_variable(i->operands[1])){
+                    block_value_t length = {NULL, i, next, 2, block, 0};
+                    length.key = key_create("(STRLEN %s#%u)", i->operands[1], version_get(&versions, i->operands[1]));
+                    if(length.key != NULL){
+                        block_values_add(list, &length);
+                    }
+                    version_increment(&versions, i->operands[0]);
+                    stack[top++] = length;
+                    i = next->next;
+                    continue;
+                }
+                break;
+            case OP_CONCAT:
+                if((end = concat_chain(i)) != NULL){
+                    block_value_t chain = {NULL, i, end, 1, block, 0};
+                    chain.key = concat_chain_key(i, end, &versions);
+                    for(instruction_t *j = i; j != end; j = j->next){
+                        chain.count++;
+                    }
+                    if(chain.key != NULL){
+                        block_values_add(list, &chain);
+                    }
+                    version_increment(&versions, CONCAT_RESULT);
+                    stack[top++] = chain;
+                    i = end->next;
+                    continue;
+                }
+                break;
+            case OP_POPS:
+                if((end = concat_sequence(i)) != NULL){
+                    version_increment(&versions, "GF@?PARAM_1");
+                    version_increment(&versions, "GF@?PARAM_2");
+                    version_increment(&versions, "GF@?RESULT_1");
+                    block_operation(list, stack, &top, 2, "CONCAT", false, i, end, block);
+                    i = end->next;
+                    continue;
+                }
+                if((end = coalesce_sequence(i)) != NULL){
+                    version_increment(&versions, "GF@?COALESCE_1");
+                    version_increment(&versions, "GF@?COALESCE_2");
+                    block_operation(list, stack, &top, 2, "??", false, i, end, block);
+                    i = end->next;
+                    continue;
+                }
+                if(top > 0){
+                    free(stack[--top].key);
+                }
+                version_increment(&versions, i->operands[0]);
+                i = next;
+                continue;
+            case OP_CREATEFRAME:
+                if((end = int2floats_sequence(i)) != NULL){
+                    block_operation(list, stack, &top, 1, "INT2FLOATS", false, i, end, block);
+                    i = end->next;
+                    continue;
+                }
+                break;
+            case OP_ADDS:
+            case OP_SUBS:
+            case OP_MULS:
+            case OP_DIVS:
+            case OP_IDIVS:
+            case OP_LTS:
+            case OP_GTS:
+            case OP_EQS:
+            case OP_ANDS:
+            case OP_ORS:
+                block_operation(list, stack, &top, 2, instruction_table[i->opcode].name,
+                                operation_is_commutative(i->opcode), i, i, block);
+                i = next;
+                continue;
+            case OP_NOTS:
+            case OP_INT2FLOATS:
+                block_operation(list, stack, &top, 1, instruction_table[i->opcode].name, false, i, i, block);
+                i = next;
+                continue;
+            default:
+                break;
+        }
+
+        // other instructions can not be part of computation on stack
+        block_stack_clear(stack, &top);
+
+        // local frame or control flow changes in new basic block
+        switch(i->opcode){
+            case OP_PUSHFRAME:
+            case OP_POPFRAME:
+            case OP_LABEL:
+            case OP_JUMP:
+            case OP_JUMPIFEQ:
+            case OP_JUMPIFNEQ:
+            case OP_JUMPIFEQS:
+            case OP_JUMPIFNEQS:
+            case OP_CALL:
+            case OP_RETURN:
+            case OP_EXIT:
+            case OP_CREATEFRAME:
+            case OP_CLEARS:
+            case OP_UNKNOWN:
+                block++;
+                break;
+            default:
+                if(instruction_table[i->opcode].writes_target && i->operand_count > 0){
+                    version_increment(&versions, i->operands[0]);
+                }
+                break;
+        }
+
+        i = next;
+    }
+
+    block_stack_clear(stack, &top);
+    name_set_dispose(&versions.names);
+    free(versions.versions);
+}
+
+/**
+ * Replaces computation of value by push of variable
+ * @param code generated instructions
+ * @param value replaced computation
+ * @param variable variable with result of computation
+*/
+static void block_value_replace(code_buffer_t *code, block_value_t *value, const char *variable){
+    instruction_t *push = instruction_create(OP_PUSHS, variable, NULL, NULL);
+    if(push == NULL){
+        return;
+    }
+    push->blank_line = value->start->blank_line;
+    code_buffer_insert_before(code, value->start, push);
+
+    instruction_t *end = value->end->next;
+    for(instruction_t *i = value->start; i != end;){
+        i = code_buffer_remove(code, i);
+    }
+}
+
+/**
+ * Checks if variable is not changed between two instructions
+ * @param from first instruction (excluded)
+ * @param to last instruction (excluded)
+ * @param variable checked variable
+ * @return bool
+*/
+static bool variable_unchanged(instruction_t *from, instruction_t *to, const char *variable){
+    for(instruction_t *i = from->next; i != NULL && i != to; i = i->next){
+        if(i->opcode < OP_UNKNOWN && instruction_table[i->opcode].writes_target &&
+           i->operand_count > 0 && strcmp(i->operands[0], variable) == 0){
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Compares values by basic block, computation and order in code (for qsort)
+ * @param a first value
+ * @param b second value
+ * @return negative, zero or positive number
+*/
+static int block_value_compare(const void *a, const void *b){
+    const block_value_t *first = a;
+    const block_value_t *second = b;
+
+    if(first->block != second->block){
+        return first->block < second->block ? -1 : 1;
+    }
+
+    int keys = strcmp(first->key, second->key);
+    if(keys != 0){
+        return keys;
+    }
+
+    return first->index < second->index ? -1 : first->index > second->index;
+}
+
+/**
+ * Finds most profitable repeated computation and replaces its repetitions
+ * @param code generated instructions
+ * @return true if code was changed
+*/
+static bool eliminate_common_subexpression(code_buffer_t *code){
+    block_values_t list = {NULL, 0, 0};
+    block_values_collect(code, &list);
+
+    // same computations of one basic block are next to each other
+    if(list.count > 0){
+        qsort(list.values, list.count, sizeof(block_value_t), block_value_compare);
+    }
+
+    int best_savings = 0;
+    unsigned best = 0;
+    unsigned best_end = 0;
+    const char *best_store = NULL;
+
+    for(unsigned i = 0; i < list.count;){
+        block_value_t *first = &list.values[i];
+        unsigned end = i + 1;
+        int savings = 0;
+
+        while(end < list.count && list.values[end].block == first->block &&
+              strcmp(list.values[end].key, first->key) == 0){
+            savings += list.values[end].count - 1;
+            end++;
+        }
+        if(end == i + 1){
+            i = end;
+            continue;
+        }
+
+        // result is already assigned to variable, which is not changed before repetitions
+        instruction_t *store = first->end->next;
+        if(store != NULL && store->opcode == OP_DEFVAR && instruction_is(store->next, OP_POPS, store->operands[0])){
+            store = store->next;
+        }
+        bool stored = store != NULL && store->opcode == OP_POPS &&
+                      (operand_in_frame(store->operands[0], "LF") || operand_in_frame(store->operands[0], "GF")) &&
+                      strncmp(store->operands[0], "GF@?", 4) != 0 &&
+                      variable_unchanged(store, list.values[end - 1].start, store->operands[0]);
+
+        if(!stored){
+            savings -= 2; // POPS and PUSHS of temporary variable
+        }
+
+        if(savings > best_savings){
+            best_savings = savings;
+            best = i;
+            best_end = end;
+            best_store = stored ? store->operands[0] : NULL;
+        }
+
+        i = end;
+    }
+
+    if(best_savings > 0){
+        block_value_t *first = &list.values[best];
+        char *name = NULL;
+
+        if(best_store != NULL){
+            name = key_create("%s", best_store);
+        } else {
+            char temporary[32];
+            temporary_name(temporary, sizeof(temporary), CSE_PREFIX, cse_id++);
+            name = key_create("%s", temporary);
+
+            instruction_t *defvar = instruction_create(OP_DEFVAR, temporary, NULL, NULL);
+            if(defvar != NULL){
+                defvar->blank_line = true;
+                code_buffer_insert_after(code, frame_entry(code, first->start), defvar);
+            }
+            code_buffer_insert_after(code, first->end, instruction_create(OP_PUSHS, temporary, NULL, NULL));
+            code_buffer_insert_after(code, first->end, instruction_create(OP_POPS, temporary, NULL, NULL));
+        }
+
+        for(unsigned j = best + 1; j < best_end && name != NULL; j++){
+            block_value_replace(code, &list.values[j], name);
+        }
+        free(name);
+    }
+
+    for(unsigned i = 0; i < list.count; i++){
+        free(list.values[i].key);
+    }
+    free(list.values);
+
+    return best_savings > 0;
+}
+
+void code_optimizer_eliminate_common_subexpressions(code_buffer_t *code){
+    while(eliminate_common_subexpression(code));
+}
+
+/**
+ * Finds label in code before instruction
+ * @param instruction instruction after label
+ * @param label name of label
+ * @return LABEL instruction or NULL
+*/
+static instruction_t *label_find_before(instruction_t *instruction, const char *label){
+    for(instruction_t *i = instruction; i != NULL; i = i->prev){
+        if(instruction_is(i, OP_LABEL, label)){
+            return i;
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * Checks if condition of loop can be copied to the end of loop
+ * @param start first instruction of condition
+ * @param end first instruction after condition
+ * @return bool
+*/
+static bool condition_is_copyable(instruction_t *start, instruction_t *end){
+    unsigned size = 0;
+
+    for(instruction_t *i = start; i != end; i = i->next){
+        if(++size > ROTATE_MAX_SIZE){
+            return false;
+        }
+
+        switch(i->opcode){
+            case OP_DEFVAR:
+            case OP_CALL:
+            case OP_RETURN:
+            case OP_UNKNOWN:
+                return false;
+            case OP_JUMP:
+            case OP_JUMPIFEQ:
+            case OP_JUMPIFNEQ:
+            case OP_JUMPIFEQS:
+            case OP_JUMPIFNEQS: {
+                // jumps of ?? stay inside of condition
+                bool inside = false;
+                for(instruction_t *j = start; j != end && !inside; j = j->next){
+                    inside = instruction_is(j, OP_LABEL, i->operands[0]);
+                }
+                if(!inside){
+                    return false;
+                }
+                break;
+            }
+            default:
+                break;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Rotates one while loop, condition is tested at the end of loop
+ * @param code generated instructions
+ * @param back_jump JUMP to the beginning of loop followed by end label of loop
+ * @return bool
+*/
+static bool loop_rotate(code_buffer_t *code, instruction_t *back_jump){
+    instruction_t *end_label = back_jump->next;
+    instruction_t *header = label_find_before(back_jump, back_jump->operands[0]);
+    if(header == NULL){
+        return false;
+    }
+
+    // LABEL header, condition, PUSHS bool@true, JUMPIFNEQS end, JUMP body, LABEL body
+    instruction_t *exit = header->next;
+    while(exit != back_jump && !instruction_is(exit, OP_JUMPIFNEQS, end_label->operands[0])){
+        exit = exit->next;
+    }
+
+    instruction_t *push = exit->prev;
+    instruction_t *body_jump = exit->next;
+    instruction_t *body_label = body_jump != NULL ? body_jump->next : NULL;
+
+    if(exit == back_jump || !instruction_is(push, OP_PUSHS, "bool@true") ||
+       body_jump == NULL || body_jump->opcode != OP_JUMP ||
+       !instruction_is(body_label, OP_LABEL, body_jump->operands[0]) ||
+       !condition_is_copyable(header->next, push)){
+        return false;
+    }
+
+    // condition at the end of loop jumps back to body
+    for(instruction_t *i = header->next; i != exit; i = i->next){
+        instruction_t *copy = instruction_copy(i);
+        if(copy == NULL){
+            continue;
+        }
+
+        if(instruction_has_label(copy)){
+            char *renamed = key_create("%s$R", copy->operands[0]);
+            if(renamed != NULL){
+                instruction_set_operand(copy, 0, renamed);
+                free(renamed);
+            }
+        }
+
+        code_buffer_insert_before(code, back_jump, copy);
+    }
+    code_buffer_insert_before(code, back_jump, instruction_create(OP_JUMPIFEQS, body_label->operands[0], NULL, NULL));
+
+    code_buffer_remove(code, back_jump);
+    code_buffer_remove(code, body_jump);
+
+    return true;
+}
+
+void code_optimizer_rotate_loops(code_buffer_t *code){
+    for(instruction_t *i = code->head; i != NULL; i = i->next){
+        if(i->opcode == OP_JUMP && i->next != NULL && i->next->opcode == OP_LABEL){
+            instruction_t *end_label = i->next;
+            if(loop_rotate(code, i)){
+                i = end_label;
+            }
+        }
+    }
+}
+
+/**
+ * Replaces comparison of two pushed values and conditional jump by jump with operands
+ * @param code generated instructions
+ * @param compare EQS, LTS or GTS
+ * @param jump conditional stack jump
+ * @param jump_if_true jump is taken when result of comparison is true
+ * @param condition_defined DEFVAR of condition variable exists
+ * @return new jump or NULL on allocation error
+*/
+static instruction_t *branch_from_operands(code_buffer_t *code, instruction_t *compare, instruction_t *jump, bool jump_if_true,
+                                 bool *condition_defined){
+    instruction_t *second = compare->prev;
+    instruction_t *first = second->prev;
+    instruction_t *branch = NULL;
+
+    if(compare->opcode == OP_EQS){
+        branch = instruction_create(jump_if_true ? OP_JUMPIFEQ : OP_JUMPIFNEQ, jump->operands[0],
+                                    first->operands[0], second->operands[0]);
+    } else {
+        if(!*condition_defined){
+            code_buffer_insert_after(code, NULL, instruction_create(OP_DEFVAR, CONDITION_VARIABLE, NULL, NULL));
+            *condition_defined = true;
+        }
+
+        instruction_t *result = instruction_create(compare->opcode == OP_LTS ? OP_LT : OP_GT, CONDITION_VARIABLE,
+                                                   first->operands[0], second->operands[0]);
+        if(result == NULL){
+            return NULL;
+        }
+        result->blank_line = first->blank_line;
+        result->line = compare->line;
+        result->column = compare->column;
+        code_buffer_insert_before(code, first, result);
+        branch = instruction_create(jump_if_true ? OP_JUMPIFEQ : OP_JUMPIFNEQ, jump->operands[0],
+                                    CONDITION_VARIABLE, "bool@true");
+    }
+
+    if(branch == NULL){
+        return NULL;
+    }
+    branch->line = jump->line;
+    branch->column = jump->column;
+    code_buffer_insert_after(code, jump, branch);
+
+    for(instruction_t *i = first; i != branch;){
+        i = code_buffer_remove(code, i);
+    }
+
+    return branch;
+}
+
+void code_optimizer_direct_branches(code_buffer_t *code){
+    bool condition_defined = false;
+
+    for(instruction_t *i = code->head; i != NULL; i = i->next){
+        if((i->opcode != OP_JUMPIFEQS && i->opcode != OP_JUMPIFNEQS) || !instruction_is(i->prev, OP_PUSHS, "bool@true")){
+            continue;
+        }
+
+        instruction_t *jump = i;
+        instruction_t *push = i->prev;
+        bool jump_if_true = jump->opcode == OP_JUMPIFEQS;
+
+        // negation changes sense of jump
+        while(push->prev != NULL && push->prev->opcode == OP_NOTS){
+            code_buffer_remove(code, push->prev);
+            jump_if_true = !jump_if_true;
+        }
+
+        instruction_t *compare = push->prev;
+        bool compared = compare != NULL &&
+                        (compare->opcode == OP_EQS || compare->opcode == OP_LTS || compare->opcode == OP_GTS);
+        bool operands = compared && compare->prev != NULL && compare->prev->opcode == OP_PUSHS &&
+                        compare->prev->prev != NULL && compare->prev->prev->opcode == OP_PUSHS;
+
+        instruction_t *branch = operands ? branch_from_operands(code, compare, jump, jump_if_true, &condition_defined) : NULL;
+
+        if(branch != NULL){
+            i = branch;
+        } else if(compare != NULL && compare->opcode == OP_PUSHS){
+            // condition is stored in variable
+            branch = instruction_create(jump_if_true ? OP_JUMPIFEQ : OP_JUMPIFNEQ, jump->operands[0],
+                                        compare->operands[0], "bool@true");
+            if(branch != NULL){
+                code_buffer_insert_after(code, jump, branch);
+                code_buffer_remove(code, compare);
+                code_buffer_remove(code, push);
+                code_buffer_remove(code, jump);
+                i = branch;
+            }
+        } else if(compared && compare->opcode == OP_EQS){
+            // values on stack are compared by jump
+            code_buffer_remove(code, compare);
+            code_buffer_remove(code, push);
+            jump->opcode = jump_if_true ? OP_JUMPIFEQS : OP_JUMPIFNEQS;
+        } else {
+            jump->opcode = jump_if_true ? OP_JUMPIFEQS : OP_JUMPIFNEQS;
+        }
+    }
+}
+
+/**
+ * Adds variable to set
+ * @param set set of variables
+ * @param index index of variable
+*/
+static void set_add(unsigned *set, unsigned index){
+    set[index / SET_WORD_BITS] |= 1u << (index % SET_WORD_BITS);
+}
+
+/**
+ * Removes variable from set
+ * @param set set of variables
+ * @param index index of variable
+*/
+static void set_remove(unsigned *set, unsigned index){
+    set[index / SET_WORD_BITS] &= ~(1u << (index % SET_WORD_BITS));
+}
+
+/**
+ * Checks if variable is in set
+ * @param set set of variables
+ * @param index index of variable
+ * @return bool
+*/
+static bool set_contains(unsigned *set, unsigned index){
+    return (set[index / SET_WORD_BITS] >> (index % SET_WORD_BITS)) & 1u;
+}
+
+/**
+ * Compares names of variables (for qsort and bsearch)
+ * @param a pointer to first name
+ * @param b pointer to second name
+ * @return negative, zero or positive number
+*/
+static int variable_name_compare(const void *a, const void *b){
+    return strcmp(*(char * const *)a, *(char * const *)b);
+}
+
+/**
+ * Finds index of variable
+ * @param variables collected variables
+ * @param operand operand of instruction
+ * @return index of variable or count of variables if operand is not collected variable
+*/
+static unsigned variable_index(frame_variables_t *variables, const char *operand){
+    char **found = bsearch(&operand, variables->names, variables->count, sizeof(char *), variable_name_compare);
+    return found == NULL ? variables->count : (unsigned)(found - variables->names);
+}
+
+/**
+ * Finds index of local variable of function (or variable of program)
+ * @param variables variables of function
+ * @param operand operand of instruction
+ * @return index of variable or count of variables if operand is not local variable of function
+*/
+static unsigned frame_variable_index(frame_variables_t *variables, const char *operand){
+    if(!variables->all_frames && !operand_in_frame(operand, "LF")){
+        return variables->count;
+    }
+
+    return variable_index(variables, operand);
+}
+
+/**
+ * Frees variables of function
+ * @param variables disposed variables
+*/
+static void frame_variables_dispose(frame_variables_t *variables){
+    for(unsigned i = 0; i < variables->count; i++){
+        free(variables->names[i]);
+    }
+    free(variables->names);
+    free(variables->order);
+    free(variables->interference);
+    free(variables->called_reads);
+}
+
+/**
+ * Collects local variables defined in function
+ * @param region region of function
+ * @param variables found variables
+ * @return false if function has too many variables or on allocation error
+*/
+static bool frame_variables_collect(function_region_t *region, frame_variables_t *variables){
+    unsigned count = 0;
+    for(instruction_t *i = region->label; i != region->end; i = i->next){
+        count += i->opcode == OP_DEFVAR && operand_in_frame(i->operands[0], "LF");
+    }
+
+    variables->names = NULL;
+    variables->order = NULL;
+    variables->interference = NULL;
+    variables->called_reads = NULL;
+    variables->count = 0;
+    variables->all_frames = false;
+
+    if(count < 2 || count > LIVENESS_MAX_VARIABLES){
+        return false;
+    }
+
+    variables->words = (count + SET_WORD_BITS - 1) / SET_WORD_BITS;
+    variables->names = malloc(count * sizeof(char *));
+    variables->order = malloc(count * sizeof(unsigned));
+    variables->interference = calloc((size_t)count * variables->words, sizeof(unsigned));
+    if(variables->names == NULL || variables->order == NULL || variables->interference == NULL){
+        fprintf(stderr, "code_optimizer: frame_variables_collect: allocation failed.\n");
+        frame_variables_dispose(variables);
+        return false;
+    }
+
+    for(instruction_t *i = region->label; i != region->end; i = i->next){
+        if(i->opcode == OP_DEFVAR && operand_in_frame(i->operands[0], "LF")){
+            char *name = key_create("%s", i->operands[0]);
+            if(name == NULL){
+                frame_variables_dispose(variables);
+                return false;
+            }
+            variables->names[variables->count++] = name;
+        }
+    }
+
+    qsort(variables->names, variables->count, sizeof(char *), variable_name_compare);
+
+    // variables are assigned to slots in order of their definitions
+    count = 0;
+    for(instruction_t *i = region->label; i != region->end; i = i->next){
+        if(i->opcode == OP_DEFVAR && operand_in_frame(i->operands[0], "LF")){
+            variables->order[count++] = frame_variable_index(variables, i->operands[0]);
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Gets variable written by instruction
+ * @param variables variables of function
+ * @param instruction checked instruction
+ * @return index of variable or count of variables
+*/
+static unsigned instruction_defined_variable(frame_variables_t *variables, instruction_t *instruction){
+    if(instruction->opcode == OP_DEFVAR || instruction->opcode >= OP_UNKNOWN ||
+       !instruction_table[instruction->opcode].writes_target || instruction->operand_count == 0){
+        return variables->count;
+    }
+
+    return frame_variable_index(variables, instruction->operands[0]);
+}
+
+/**
+ * Marks all variables of frame as live
+ * @param variables variables of program
+ * @param live set of live variables
+ * @param frame name of frame
+*/
+static void live_add_frame(frame_variables_t *variables, unsigned *live, const char *frame){
+    for(unsigned i = 0; i < variables->count; i++){
+        if(operand_in_frame(variables->names[i], frame)){
+            set_add(live, i);
+        }
+    }
+}
+
+/**
+ * Updates set of live variables by instruction (set after instruction -> set before instruction)
+ * @param variables variables of function
+ * @param instruction executed instruction
+ * @param live set of live variables
+*/
+static void live_transfer(frame_variables_t *variables, instruction_t *instruction, unsigned *live){
+    if(instruction->opcode == OP_DEFVAR){
+        return;
+    }
+
+    // frames of program are read by called function and by caller after return
+    if(variables->all_frames){
+        switch(instruction->opcode){
+            case OP_CALL:
+                if(variables->called_reads != NULL){
+                    for(unsigned w = 0; w < variables->words; w++){
+                        live[w] |= variables->called_reads[w];
+                    }
+                } else {
+                    live_add_frame(variables, live, "GF");
+                }
+                live_add_frame(variables, live, "TF");
+                break;
+            case OP_RETURN:
+                live_add_frame(variables, live, "GF");
+                break;
+            case OP_PUSHFRAME:
+                live_add_frame(variables, live, "TF");
+                break;
+            default:
+                break;
+        }
+    }
+
+    // SETCHAR changes only one char of its target
+    unsigned defined = instruction_defined_variable(variables, instruction);
+    if(defined < variables->count && instruction->opcode != OP_SETCHAR){
+        set_remove(live, defined);
+    }
+
+    unsigned first_used = defined < variables->count || instruction_has_label(instruction) ? 1 : 0;
+    if(instruction->opcode == OP_SETCHAR){
+        first_used = 0;
+    }
+
+    for(unsigned i = first_used; i < instruction->operand_count; i++){
+        unsigned used = frame_variable_index(variables, instruction->operands[i]);
+        if(used < variables->count){
+            set_add(live, used);
+        }
+    }
+}
+
+/**
+ * Finds block starting with label
+ * @param blocks blocks of function
+ * @param count count of blocks
+ * @param label name of label
+ * @return index of block or count if label is not in function
+*/
+static unsigned live_block_find(live_block_t *blocks, unsigned count, const char *label){
+    for(unsigned i = 0; i < count; i++){
+        if(instruction_is(blocks[i].first, OP_LABEL, label)){
+            return i;
+        }
+    }
+
+    return count;
+}
+
+/**
+ * Splits instructions to basic blocks and connects them by jumps
+ * @param first first instruction (first instruction of body of function)
+ * @param end first instruction after split instructions (end of function)
+ * @param count count of created blocks
+ * @return blocks (have to be freed) or NULL if some jump leaves instructions or on allocation error
+*/
+static live_block_t *live_blocks_create(instruction_t *first, instruction_t *end, unsigned *count){
+    unsigned size = 1;
+    for(instruction_t *i = first; i != end; i = i->next){
+        size += i->opcode == OP_LABEL || instruction_has_label(i) || i->opcode == OP_RETURN || i->opcode == OP_EXIT;
+    }
+
+    live_block_t *blocks = calloc(size, sizeof(live_block_t));
+    if(blocks == NULL){
+        fprintf(stderr, "code_optimizer: live_blocks_create: allocation failed.\n");
+        return NULL;
+    }
+
+    // blocks start by label and end by jump or return
+    *count = 0;
+    bool starts_block = true;
+    for(instruction_t *i = first; i != end; i = i->next){
+        if(starts_block || i->opcode == OP_LABEL){
+            blocks[(*count)++].first = i;
+        }
+        blocks[*count - 1].last = i;
+
+        starts_block = i->opcode == OP_RETURN || i->opcode == OP_EXIT || (instruction_has_label(i) && i->opcode != OP_LABEL);
+    }
+
+    for(unsigned b = 0; b < *count; b++){
+        instruction_t *last = blocks[b].last;
+        bool falls_through = last->opcode != OP_JUMP && last->opcode != OP_RETURN && last->opcode != OP_EXIT;
+
+        if(falls_through && b + 1 < *count){
+            blocks[b].successors[blocks[b].successor_count++] = b + 1;
+        }
+
+        if(instruction_has_label(last) && last->opcode != OP_LABEL){
+            unsigned target = live_block_find(blocks, *count, last->operands[0]);
+            if(target == *count){
+                free(blocks);
+                return NULL;
+            }
+            blocks[b].successors[blocks[b].successor_count++] = target;
+        }
+    }
+
+    return blocks;
+}
+
+/**
+ * Computes variables live at the beginning and at the end of blocks
+ * @param variables variables of function
+ * @param blocks blocks of function
+ * @param count count of blocks
+ * @return false on allocation error
+*/
+static bool live_blocks_analyse(frame_variables_t *variables, live_block_t *blocks, unsigned count){
+    unsigned words = variables->words;
+    unsigned *sets = calloc((size_t)(2 * count + 1) * words, sizeof(unsigned));
+    if(sets == NULL){
+        fprintf(stderr, "code_optimizer: live_blocks_analyse: allocation failed.\n");
+        return false;
+    }
+
+    for(unsigned b = 0; b < count; b++){
+        blocks[b].in = sets + (size_t)(2 * b) * words;
+        blocks[b].out = sets + (size_t)(2 * b + 1) * words;
+    }
+    unsigned *live = sets + (size_t)(2 * count) * words;
+
+    // backward dataflow, blocks are visited from the end of function until nothing changes
+    bool changed = true;
+    while(changed){
+        changed = false;
+
+        for(unsigned b = count; b-- > 0;){
+            for(unsigned s = 0; s < blocks[b].successor_count; s++){
+                unsigned *in = blocks[blocks[b].successors[s]].in;
+                for(unsigned w = 0; w < words; w++){
+                    blocks[b].out[w] |= in[w];
+                }
+            }
+
+            memcpy(live, blocks[b].out, words * sizeof(unsigned));
+            for(instruction_t *i = blocks[b].last; i != blocks[b].first->prev; i = i->prev){
+                live_transfer(variables, i, live);
+            }
+
+            if(memcmp(live, blocks[b].in, words * sizeof(unsigned)) != 0){
+                memcpy(blocks[b].in, live, words * sizeof(unsigned));
+                changed = true;
+            }
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Marks two variables as live at the same time
+ * @param variables variables of function
+ * @param a index of first variable
+ * @param b index of second variable
+*/
+static void variables_interfere(frame_variables_t *variables, unsigned a, unsigned b){
+    set_add(variables->interference + (size_t)a * variables->words, b);
+    set_add(variables->interference + (size_t)b * variables->words, a);
+}
+
+/**
+ * Finds pairs of variables, which can not share one slot of frame
+ * (variable written while other is live, copied variables can share slot)
+ * @param variables variables of function
+ * @param blocks analysed blocks of function
+ * @param count count of blocks
+ * @return false on allocation error
+*/
+static bool variables_interference_build(frame_variables_t *variables, live_block_t *blocks, unsigned count){
+    unsigned *live = malloc(variables->words * sizeof(unsigned));
+    if(live == NULL){
+        fprintf(stderr, "code_optimizer: variables_interference_build: allocation failed.\n");
+        return false;
+    }
+
+    for(unsigned b = 0; b < count; b++){
+        memcpy(live, blocks[b].out, variables->words * sizeof(unsigned));
+
+        for(instruction_t *i = blocks[b].last; i != blocks[b].first->prev; i = i->prev){
+            unsigned defined = instruction_defined_variable(variables, i);
+            unsigned copied = i->opcode == OP_MOVE ? frame_variable_index(variables, i->operands[1]) : variables->count;
+
+            for(unsigned v = 0; defined < variables->count && v < variables->count; v++){
+                if(v != defined && v != copied && set_contains(live, v)){
+                    variables_interfere(variables, defined, v);
+                }
+            }
+
+            live_transfer(variables, i, live);
+        }
+    }
+    free(live);
+
+    // variables read before their first assignment keep their own slot
+    for(unsigned v = 0; v < variables->count; v++){
+        for(unsigned other = 0; set_contains(blocks[0].in, v) && other < variables->count; other++){
+            if(other != v){
+                variables_interfere(variables, v, other);
+            }
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Assigns slots to variables (variable gets first slot without interfering variable)
+ * @param variables variables of function
+ * @param representatives index of variable naming slot of each variable
+ * @return count of variables sharing slot with other variable
+*/
+static unsigned variables_assign_slots(frame_variables_t *variables, unsigned *representatives){
+    unsigned words = variables->words;
+    unsigned *members = calloc((size_t)variables->count * words, sizeof(unsigned));
+    if(members == NULL){
+        fprintf(stderr, "code_optimizer: variables_assign_slots: allocation failed.\n");
+        return 0;
+    }
+
+    unsigned merged = 0;
+    for(unsigned o = 0; o < variables->count; o++){
+        unsigned v = variables->order[o];
+        unsigned *interference = variables->interference + (size_t)v * words;
+        representatives[v] = v;
+
+        // slots are named by their first variable
+        for(unsigned p = 0; p < o; p++){
+            unsigned slot = variables->order[p];
+            if(representatives[slot] != slot){
+                continue;
+            }
+
+            bool is_free = true;
+            for(unsigned w = 0; w < words && is_free; w++){
+                is_free = (interference[w] & members[(size_t)slot * words + w]) == 0;
+            }
+
+            if(is_free){
+                representatives[v] = slot;
+                merged++;
+                break;
+            }
+        }
+
+        set_add(members + (size_t)representatives[v] * words, v);
+    }
+
+    free(members);
+    return merged;
+}
+
+/**
+ * Renames variables of function to variables naming their slots and removes their definitions
+ * @param code generated instructions
+ * @param region region of function
+ * @param variables variables of function
+ * @param representatives index of variable naming slot of each variable
+*/
+static void variables_rename(code_buffer_t *code, function_region_t *region, frame_variables_t *variables, unsigned *representatives){
+    for(instruction_t *i = region->label->next; i != region->end;){
+        if(i->opcode == OP_DEFVAR){
+            unsigned v = frame_variable_index(variables, i->operands[0]);
+            i = v < variables->count && representatives[v] != v ? code_buffer_remove(code, i) : i->next;
+            continue;
+        }
+
+        for(unsigned o = 0; o < i->operand_count; o++){
+            unsigned v = frame_variable_index(variables, i->operands[o]);
+            if(v < variables->count && representatives[v] != v){
+                instruction_set_operand(i, o, variables->names[representatives[v]]);
+            }
+        }
+
+        // copies between variables in one slot are not needed
+        if(i->opcode == OP_MOVE && strcmp(i->operands[0], i->operands[1]) == 0){
+            i = code_buffer_remove(code, i);
+        } else {
+            i = i->next;
+        }
+    }
+}
+
+/**
+ * Shares slots of frame between local variables of one function
+ * @param code generated instructions
+ * @param region region of function
+*/
+static void function_share_slots(code_buffer_t *code, function_region_t *region){
+    frame_variables_t variables;
+    if(!frame_variables_collect(region, &variables)){
+        return;
+    }
+
+    unsigned count = 0;
+    live_block_t *blocks = live_blocks_create(region->label->next, region->end, &count);
+    if(blocks == NULL){
+        frame_variables_dispose(&variables);
+        return;
+    }
+
+    unsigned *representatives = malloc(variables.count * sizeof(unsigned));
+    if(representatives != NULL && live_blocks_analyse(&variables, blocks, count)){
+        // definitions of slots have to be executed before all of their variables are used
+        if(variables_interference_build(&variables, blocks, count) && variables_assign_slots(&variables, representatives) > 0){
+            variables_rename(code, region, &variables, representatives);
+            function_hoist_definitions(code, region);
+        }
+
+        free(blocks[0].in);
+    }
+
+    free(representatives);
+    free(blocks);
+    frame_variables_dispose(&variables);
+}
+
+void code_optimizer_share_frame_slots(code_buffer_t *code){
+    function_region_t region;
+
+    for(instruction_t *i = code->head; i != NULL;){
+        if(!function_region_at(i, &region)){
+            i = i->next;
+            continue;
+        }
+
+        if(region.label->next != NULL && region.label->next->opcode == OP_PUSHFRAME){
+            function_share_slots(code, &region);
+        }
+
+        i = region.end;
+    }
+}
+
+/**
+ * @brief stack operation and its three-address instruction
+ */
+static const opcode_t stack_operations[][2] = {
+    {OP_ADDS, OP_ADD}, {OP_SUBS, OP_SUB}, {OP_MULS, OP_MUL}, {OP_DIVS, OP_DIV}, {OP_IDIVS, OP_IDIV},
+    {OP_LTS, OP_LT}, {OP_GTS, OP_GT}, {OP_EQS, OP_EQ}, {OP_ANDS, OP_AND}, {OP_ORS, OP_OR}, {OP_STRI2INTS, OP_STRI2INT},
+    {OP_NOTS, OP_NOT}, {OP_INT2FLOATS, OP_INT2FLOAT}, {OP_FLOAT2INTS, OP_FLOAT2INT}, {OP_INT2CHARS, OP_INT2CHAR},
+};
+
+/**
+ * Patterns of instruction selection (the first matching pattern is used, so longer patterns are first)
+ */
+static const selection_pattern_t selection_patterns[] = {
+    // a * b - c
+    {{"PUSHS $1", "PUSHS $2", "@A", "PUSHS $3", "@B", "POPS $0"}, {"@A $0 $1 $2", "@B $0 $0 $3"}, {0, 3}, -1},
+    // a - b * c
+    {{"PUSHS $1", "PUSHS $2", "PUSHS $3", "@A", "@B", "POPS $0"}, {"@A $0 $2 $3", "@B $0 $1 $0"}, {0, 1}, -1},
+    // a != b
+    {{"PUSHS $1", "PUSHS $2", "@A", "%B", "POPS $0"}, {"@A $0 $1 $2", "%B $0 $0"}, {-1, -1}, -1},
+    // Int2Double(a) + b
+    {{"PUSHS $1", "%A", "PUSHS $2", "@B", "POPS $0"}, {"%A $0 $1", "@B $0 $0 $2"}, {0, 2}, -1},
+    // a + b
+    {{"PUSHS $1", "PUSHS $2", "@A", "POPS $0"}, {"@A $0 $1 $2"}, {-1, -1}, -1},
+    // !a, Int2Double(a)
+    {{"PUSHS $1", "%A", "POPS $0"}, {"%A $0 $1"}, {-1, -1}, -1},
+    // length(a), chr(a), a + b of strings computed to temporary variable
+    {{"STRLEN $3 $1", "PUSHS $3", "POPS $0"}, {"STRLEN $0 $1"}, {-1, -1}, 3},
+    {{"INT2CHAR $3 $1", "PUSHS $3", "POPS $0"}, {"INT2CHAR $0 $1"}, {-1, -1}, 3},
+    {{"CONCAT $3 $1 $2", "PUSHS $3", "POPS $0"}, {"CONCAT $0 $1 $2"}, {-1, -1}, 3},
+    // assignment
+    {{"PUSHS $1", "POPS $0"}, {"MOVE $0 $1"}, {-1, -1}, -1},
+};
+
+/**
+ * @brief state of matching of one pattern
+ */
+typedef struct selection_match {
+    const char *operands[SELECTION_MAX_BINDINGS]; // bound operands ($0 - $3)
+    opcode_t operations[2];                       // matched stack operations (A, B)
+    instruction_t *last;                          // last matched instruction
+} selection_match_t;
+
+/**
+ * Finds stack operation
+ * @param opcode stack opcode
+ * @param binary operation takes two operands (unary otherwise)
+ * @return index in stack_operations or count of operations if opcode is not such operation
+*/
+static unsigned stack_operation_find(opcode_t opcode, bool binary){
+    const unsigned count = sizeof(stack_operations) / sizeof(stack_operations[0]);
+    for(unsigned i = 0; i < count; i++){
+        if(stack_operations[i][0] == opcode){
+            return (instruction_table[stack_operations[i][1]].operand_count == 3) == binary ? i : count;
+        }
+    }
+    return count;
+}
+
+/**
+ * Matches one instruction of pattern
+ * @param item instruction of pattern
+ * @param instruction matched instruction
+ * @param match bindings of operands and operations
+ * @return bool
+*/
+static bool selection_item_match(const char *item, instruction_t *instruction, selection_match_t *match){
+    char name[16];
+    size_t length = strcspn(item, " ");
+    snprintf(name, sizeof(name), "%.*s", (int)length, item);
+
+    if(name[0] == '@' || name[0] == '%'){
+        unsigned operation = stack_operation_find(instruction->opcode, name[0] == '@');
+        if(operation == sizeof(stack_operations) / sizeof(stack_operations[0])){
+            return false;
+        }
+        opcode_t *bound = &match->operations[name[1] - 'A'];
+        if(*bound != OP_UNKNOWN && *bound != instruction->opcode){
+            return false;
+        }
+        *bound = instruction->opcode;
+        return true;
+    }
+
+    if(instruction_opcode(name) != instruction->opcode){
+        return false;
+    }
+
+    unsigned operand = 0;
+    for(const char *c = strchr(item, '$'); c != NULL; c = strchr(c + 1, '$'), operand++){
+        const char **bound = &match->operands[c[1] - '0'];
+        if(operand >= instruction->operand_count || (*bound != NULL && strcmp(*bound, instruction->operands[operand]) != 0)){
+            return false;
+        }
+        *bound = instruction->operands[operand];
+    }
+    return operand == instruction->operand_count;
+}
+
+/**
+ * Checks if temporary variable is written before it is read again
+ * @param instruction first instruction after matched sequence
+ * @param variable temporary variable
+ * @return bool
+*/
+static bool selection_variable_dead(instruction_t *instruction, const char *variable){
+    for(instruction_t *i = instruction; i != NULL; i = i->next){
+        bool writes = i->opcode == OP_DEFVAR || (i->opcode < OP_UNKNOWN && instruction_table[i->opcode].writes_target);
+        for(unsigned o = writes && i->opcode != OP_SETCHAR ? 1 : 0; o < i->operand_count; o++){
+            if(strcmp(i->operands[o], variable) == 0){
+                return false;
+            }
+        }
+
+        if(writes && i->operand_count > 0 && strcmp(i->operands[0], variable) == 0){
+            return true;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Matches pattern at instruction
+ * @param pattern matched pattern
+ * @param instruction first matched instruction
+ * @param match bindings of operands and operations
+ * @return bool
+*/
+static bool selection_pattern_match(const selection_pattern_t *pattern, instruction_t *instruction, selection_match_t *match){
+    memset(match->operands, 0, sizeof(match->operands));
+    match->operations[0] = OP_UNKNOWN;
+    match->operations[1] = OP_UNKNOWN;
+
+    instruction_t *i = instruction;
+    for(unsigned item = 0; item < SELECTION_MAX_LENGTH && pattern->match[item] != NULL; item++){
+        // definitions of variables are moved before replacement
+        while(item > 0 && i != NULL && i->opcode == OP_DEFVAR){
+            i = i->next;
+        }
+        if(i == NULL || !selection_item_match(pattern->match[item], i, match)){
+            return false;
+        }
+        match->last = i;
+        i = i->next;
+    }
+
+    const int *distinct = pattern->distinct;
+    if(distinct[0] >= 0 && strcmp(match->operands[distinct[0]], match->operands[distinct[1]]) == 0){
+        return false;
+    }
+
+    return pattern->dead < 0 || (operand_in_frame(match->operands[pattern->dead], "GF") &&
+                                 match->operands[pattern->dead][3] == '?' && selection_variable_dead(i, match->operands[pattern->dead]));
+}
+
+/**
+ * Creates instruction of replacement
+ * @param item instruction of replacement
+ * @param match bindings of operands and operations
+ * @return new instruction or NULL on allocation error
+*/
+static instruction_t *selection_item_create(const char *item, selection_match_t *match){
+    char name[16];
+    size_t length = strcspn(item, " ");
+    snprintf(name, sizeof(name), "%.*s", (int)length, item);
+
+    opcode_t opcode;
+    if(name[0] == '@' || name[0] == '%'){
+        opcode_t stack = match->operations[name[1] - 'A'];
+        opcode = stack_operations[stack_operation_find(stack, name[0] == '@')][1];
+    } else {
+        opcode = instruction_opcode(name);
+    }
+
+    const char *operands[MAX_OPERANDS] = {NULL, NULL, NULL};
+    unsigned operand = 0;
+    for(const char *c = strchr(item, '$'); c != NULL && operand < MAX_OPERANDS; c = strchr(c + 1, '$')){
+        operands[operand++] = match->operands[c[1] - '0'];
+    }
+
+    return instruction_create(opcode, operands[0], operands[1], operands[2]);
+}
+
+/**
+ * Replaces matched sequence by instructions of pattern
+ * @param code generated instructions
+ * @param pattern matched pattern
+ * @param first first matched instruction
+ * @param match bindings of operands and operations
+ * @return last instruction of replacement or NULL on allocation error (code is not changed)
+*/
+static instruction_t *selection_replace(code_buffer_t *code, const selection_pattern_t *pattern, instruction_t *first, selection_match_t *match){
+    instruction_t *created[SELECTION_MAX_LENGTH] = {NULL};
+    unsigned count = 0;
+    for(; count < SELECTION_MAX_LENGTH && pattern->replacement[count] != NULL; count++){
+        created[count] = selection_item_create(pattern->replacement[count], match);
+        if(created[count] == NULL){
+            for(unsigned i = 0; i < count; i++){
+                instruction_free(created[i]);
+            }
+            return NULL;
+        }
+        created[count]->line = first->line;
+        created[count]->column = first->column;
+    }
+    created[0]->blank_line = first->blank_line;
+
+    instruction_t *position = match->last->next;
+    for(unsigned i = 0; i < count; i++){
+        if(position == NULL){
+            code_buffer_append(code, created[i]);
+        } else {
+            code_buffer_insert_before(code, position, created[i]);
+        }
+    }
+
+    // matched instructions are removed, definitions of variables stay before replacement
+    instruction_t *end = match->last->next;
+    for(instruction_t *i = first; i != end;){
+        i = i->opcode == OP_DEFVAR ? i->next : code_buffer_remove(code, i);
+    }
+
+    return created[count - 1];
+}
+
+void code_optimizer_select_instructions(code_buffer_t *code){
+    const unsigned count = sizeof(selection_patterns) / sizeof(selection_patterns[0]);
+    selection_match_t match;
+
+    for(instruction_t *i = code->head; i != NULL; i = i->next){
+        for(unsigned p = 0; p < count; p++){
+            if(selection_pattern_match(&selection_patterns[p], i, &match)){
+                instruction_t *last = selection_replace(code, &selection_patterns[p], i, &match);
+                if(last != NULL){
+                    i = last;
+                }
+                break;
+            }
+        }
+    }
+}
+
+/**
+ * Collects variables defined in program (all frames)
+ * @param code generated instructions
+ * @param variables found variables (order and interference are not used)
+ * @return false if program has too many variables or on allocation error
+*/
+static bool program_variables_collect(code_buffer_t *code, frame_variables_t *variables){
+    unsigned count = 0;
+    for(instruction_t *i = code->head; i != NULL; i = i->next){
+        count += i->opcode == OP_DEFVAR;
+    }
+
+    variables->names = NULL;
+    variables->order = NULL;
+    variables->interference = NULL;
+    variables->called_reads = NULL;
+    variables->count = 0;
+    variables->all_frames = true;
+
+    if(count == 0 || count > PROGRAM_MAX_VARIABLES){
+        return false;
+    }
+
+    variables->names = malloc(count * sizeof(char *));
+    if(variables->names == NULL){
+        fprintf(stderr, "code_optimizer: program_variables_collect: allocation failed.\n");
+        return false;
+    }
+
+    for(instruction_t *i = code->head; i != NULL; i = i->next){
+        if(i->opcode == OP_DEFVAR){
+            char *name = key_create("%s", i->operands[0]);
+            if(name == NULL){
+                frame_variables_dispose(variables);
+                return false;
+            }
+            variables->names[variables->count++] = name;
+        }
+    }
+
+    // variables of inlined functions can be defined more times
+    qsort(variables->names, variables->count, sizeof(char *), variable_name_compare);
+    count = 0;
+    for(unsigned i = 0; i < variables->count; i++){
+        if(count > 0 && strcmp(variables->names[count - 1], variables->names[i]) == 0){
+            free(variables->names[i]);
+        } else {
+            variables->names[count++] = variables->names[i];
+        }
+    }
+    variables->count = count;
+    variables->words = (count + SET_WORD_BITS - 1) / SET_WORD_BITS;
+
+    return true;
+}
+
+/**
+ * Finds instruction pushing value stored by POPS (definitions of variables can be between them)
+ * @param pop POPS instruction
+ * @return PUSHS instruction or NULL
+*/
+static instruction_t *store_push(instruction_t *pop){
+    instruction_t *push = pop->prev;
+    while(push != NULL && push->opcode == OP_DEFVAR){
+        push = push->prev;
+    }
+
+    return push != NULL && push->opcode == OP_PUSHS ? push : NULL;
+}
+
+/**
+ * Checks if store to variable can be removed (MOVE or POPS of pushed value)
+ * @param instruction store to variable
+ * @param constant stored value has to be constant
+ * @return bool
+*/
+static bool store_is_removable(instruction_t *instruction, bool constant){
+    if(instruction->opcode == OP_MOVE){
+        return !constant || operand_is_constant(instruction->operands[1]);
+    }
+
+    instruction_t *push = instruction->opcode == OP_POPS ? store_push(instruction) : NULL;
+    return push != NULL && (!constant || operand_is_constant(push->operands[0]));
+}
+
+/**
+ * Removes store to variable (blank line is kept)
+ * @param code generated instructions
+ * @param store removable store
+*/
+static void store_remove(code_buffer_t *code, instruction_t *store){
+    if(store->opcode == OP_POPS){
+        instruction_t *push = store_push(store);
+        if(push->next != NULL && push->blank_line){
+            push->next->blank_line = true;
+        }
+        code_buffer_remove(code, push);
+    }
+
+    if(store->next != NULL && store->blank_line){
+        store->next->blank_line = true;
+    }
+    code_buffer_remove(code, store);
+}
+
+/**
+ * Collects global variables read by functions (they are live at every call)
+ * @param code generated instructions
+ * @param variables variables of program
+*/
+static void called_reads_collect(code_buffer_t *code, frame_variables_t *variables){
+    variables->called_reads = calloc(variables->words, sizeof(unsigned));
+    if(variables->called_reads == NULL){
+        fprintf(stderr, "code_optimizer: called_reads_collect: allocation failed.\n");
+        return;
+    }
+
+    function_region_t region;
+    for(instruction_t *i = code->head; i != NULL;){
+        if(!function_region_at(i, &region)){
+            i = i->next;
+            continue;
+        }
+
+        for(instruction_t *f = region.label; f != region.end; f = f->next){
+            unsigned first_used = f->opcode != OP_SETCHAR && f->opcode < OP_UNKNOWN && instruction_table[f->opcode].writes_target ? 1 : 0;
+            for(unsigned o = first_used; o < f->operand_count; o++){
+                unsigned used = operand_in_frame(f->operands[o], "GF") ? variable_index(variables, f->operands[o]) : variables->count;
+                if(used < variables->count){
+                    set_add(variables->called_reads, used);
+                }
+            }
+        }
+        i = region.end;
+    }
+}
+
+/**
+ * Removes variables, which are never read (definitions and all stores)
+ * @param code generated instructions
+ * @param variables variables of program
+ * @return false on allocation error
+*/
+static bool unread_variables_remove(code_buffer_t *code, frame_variables_t *variables){
+    // variable is needed if it is read or written by other instruction than removable store
+    bool *needed = calloc(variables->count, sizeof(bool));
+    if(needed == NULL){
+        fprintf(stderr, "code_optimizer: unread_variables_remove: allocation failed.\n");
+        return false;
+    }
+
+    for(instruction_t *i = code->head; i != NULL; i = i->next){
+        if(i->opcode == OP_DEFVAR){
+            continue;
+        }
+
+        unsigned defined = instruction_defined_variable(variables, i);
+        if(defined < variables->count && (i->opcode == OP_SETCHAR || !store_is_removable(i, false))){
+            needed[defined] = true;
+        }
+
+        unsigned first_used = defined < variables->count || instruction_has_label(i) ? 1 : 0;
+        for(unsigned o = i->opcode == OP_SETCHAR ? 0 : first_used; o < i->operand_count; o++){
+            unsigned used = frame_variable_index(variables, i->operands[o]);
+            if(used < variables->count){
+                needed[used] = true;
+            }
+        }
+    }
+
+    // parameters are read from temporary frame by called function
+    for(unsigned v = 0; v < variables->count; v++){
+        needed[v] = needed[v] || operand_in_frame(variables->names[v], "TF");
+    }
+
+    for(instruction_t *i = code->head; i != NULL;){
+        unsigned v = i->opcode == OP_DEFVAR ? frame_variable_index(variables, i->operands[0]) : instruction_defined_variable(variables, i);
+        instruction_t *next = i->next;
+
+        if(v < variables->count && !needed[v]){
+            if(i->opcode == OP_DEFVAR){
+                if(next != NULL && i->blank_line){
+                    next->blank_line = true;
+                }
+                code_buffer_remove(code, i);
+            } else {
+                store_remove(code, i);
+            }
+        }
+        i = next;
+    }
+
+    free(needed);
+    return true;
+}
+
+void code_optimizer_eliminate_dead_stores(code_buffer_t *code){
+    frame_variables_t variables;
+    if(!program_variables_collect(code, &variables)){
+        return;
+    }
+
+    if(!unread_variables_remove(code, &variables)){
+        frame_variables_dispose(&variables);
+        return;
+    }
+    called_reads_collect(code, &variables);
+
+    unsigned count = 0;
+    live_block_t *blocks = variables.called_reads != NULL ? live_blocks_create(code->head, NULL, &count) : NULL;
+    if(blocks == NULL || count == 0 || !live_blocks_analyse(&variables, blocks, count)){
+        free(blocks);
+        frame_variables_dispose(&variables);
+        return;
+    }
+
+    unsigned size = 0;
+    for(instruction_t *i = code->head; i != NULL; i = i->next){
+        size++;
+    }
+
+    instruction_t **removed = malloc(size * sizeof(instruction_t *));
+    unsigned *live = malloc(variables.words * sizeof(unsigned));
+    if(removed == NULL || live == NULL){
+        fprintf(stderr, "code_optimizer: code_optimizer_eliminate_dead_stores: allocation failed.\n");
+        size = 0;
+    }
+
+    // stores of constants, which are overwritten before read (mostly implicit nil of declaration)
+    unsigned removed_count = 0;
+    for(unsigned b = 0; size > 0 && b < count; b++){
+        memcpy(live, blocks[b].out, variables.words * sizeof(unsigned));
+        for(instruction_t *i = blocks[b].last; i != blocks[b].first->prev; i = i->prev){
+            unsigned defined = instruction_defined_variable(&variables, i);
+            if(defined < variables.count && i->opcode != OP_SETCHAR && !set_contains(live, defined) &&
+               !operand_in_frame(i->operands[0], "TF") && store_is_removable(i, true)){
+                removed[removed_count++] = i;
+                continue;
+            }
+            live_transfer(&variables, i, live);
+        }
+    }
+
+    for(unsigned i = 0; i < removed_count; i++){
+        store_remove(code, removed[i]);
+    }
+
+    free(live);
+    free(removed);
+    free(blocks[0].in);
+    free(blocks);
+    frame_variables_dispose(&variables);
+}
+
+/**
+ * Checks if operand is known to be non-nil
+ * @param variables variables of program
+ * @param state known non-nil variables
+ * @param operand checked operand
+ * @return bool
+*/
+static bool operand_is_nonnil(frame_variables_t *variables, nonnil_state_t *state, const char *operand){
+    if(operand_is_constant(operand)){
+        return strcmp(operand, "nil@nil") != 0;
+    }
+
+    unsigned index = variable_index(variables, operand);
+    return index < variables->count && set_contains(state->variables, index);
+}
+
+/**
+ * Sets if variable is known to be non-nil
+ * @param variables variables of program
+ * @param state known non-nil variables
+ * @param operand written variable
+ * @param nonnil written value is not nil
+*/
+static void nonnil_assign(frame_variables_t *variables, nonnil_state_t *state, const char *operand, bool nonnil){
+    unsigned index = variable_index(variables, operand);
+    if(index < variables->count){
+        if(nonnil){
+            set_add(state->variables, index);
+        } else {
+            set_remove(state->variables, index);
+        }
+    }
+}
+
+/**
+ * Forgets variables of frame (frame was changed or variables could be changed by called function)
+ * @param variables variables of program
+ * @param state known non-nil variables
+ * @param frame name of frame
+*/
+static void nonnil_forget_frame(frame_variables_t *variables, nonnil_state_t *state, const char *frame){
+    for(unsigned i = 0; i < variables->count; i++){
+        if(operand_in_frame(variables->names[i], frame)){
+            set_remove(state->variables, i);
+        }
+    }
+}
+
+/**
+ * Pushes value to data stack of state
+ * @param state known non-nil values
+ * @param nonnil pushed value is not nil
+*/
+static void nonnil_push(nonnil_state_t *state, bool nonnil){
+    // values under full stack are forgotten
+    if(state->top == VALUE_STACK_SIZE){
+        state->top = 0;
+    }
+    state->stack[state->top++] = nonnil;
+}
+
+/**
+ * Pops value from data stack of state
+ * @param state known non-nil values
+ * @return popped value is not nil (false for unknown value)
+*/
+static bool nonnil_pop(nonnil_state_t *state){
+    return state->top > 0 ? state->stack[--state->top] : false;
+}
+
+/**
+ * Updates known non-nil variables and values on stack by instruction
+ * @param variables variables of program
+ * @param instruction executed instruction
+ * @param state known non-nil variables and values
+*/
+static void nonnil_transfer(frame_variables_t *variables, instruction_t *instruction, nonnil_state_t *state){
+    const unsigned operations = sizeof(stack_operations) / sizeof(stack_operations[0]);
+
+    switch(instruction->opcode){
+        case OP_PUSHS:
+            nonnil_push(state, operand_is_nonnil(variables, state, instruction->operands[0]));
+            break;
+        case OP_POPS:
+            nonnil_assign(variables, state, instruction->operands[0], nonnil_pop(state));
+            break;
+        case OP_MOVE:
+            nonnil_assign(variables, state, instruction->operands[0], operand_is_nonnil(variables, state, instruction->operands[1]));
+            break;
+        case OP_DEFVAR:
+        case OP_READ:
+            nonnil_assign(variables, state, instruction->operands[0], false);
+            break;
+        case OP_JUMPIFEQS:
+        case OP_JUMPIFNEQS:
+            nonnil_pop(state);
+            nonnil_pop(state);
+            break;
+        case OP_CALL:
+            // called function can change global variables, its result is unknown
+            nonnil_forget_frame(variables, state, "GF");
+            nonnil_forget_frame(variables, state, "TF");
+            state->top = 0;
+            break;
+        case OP_PUSHFRAME:
+        case OP_POPFRAME:
+            nonnil_forget_frame(variables, state, "LF");
+            nonnil_forget_frame(variables, state, "TF");
+            break;
+        case OP_CREATEFRAME:
+            nonnil_forget_frame(variables, state, "TF");
+            break;
+        case OP_CLEARS:
+        case OP_RETURN:
+            state->top = 0;
+            break;
+        default:
+            // results of stack operations and of other instructions are never nil
+            if(stack_operation_find(instruction->opcode, true) < operations){
+                nonnil_pop(state);
+                nonnil_pop(state);
+                nonnil_push(state, true);
+            } else if(stack_operation_find(instruction->opcode, false) < operations){
+                nonnil_pop(state);
+                nonnil_push(state, true);
+            } else if(instruction->opcode < OP_UNKNOWN && instruction_table[instruction->opcode].writes_target){
+                nonnil_assign(variables, state, instruction->operands[0], true);
+            }
+            break;
+    }
+}
+
+/**
+ * Gets variable compared with nil by last instruction of block (JUMPIFEQ/JUMPIFNEQ label var nil@nil)
+ * @param variables variables of program
+ * @param block checked block
+ * @param jump variable is not nil if jump is taken (not nil if jump is not taken otherwise)
+ * @return index of variable or count of variables
+*/
+static unsigned nil_compared_variable(frame_variables_t *variables, live_block_t *block, bool *jump){
+    instruction_t *last = block->last;
+    if((last->opcode != OP_JUMPIFEQ && last->opcode != OP_JUMPIFNEQ)){
+        return variables->count;
+    }
+
+    *jump = last->opcode == OP_JUMPIFNEQ;
+    if(strcmp(last->operands[2], "nil@nil") == 0){
+        return variable_index(variables, last->operands[1]);
+    }
+    if(strcmp(last->operands[1], "nil@nil") == 0){
+        return variable_index(variables, last->operands[2]);
+    }
+    return variables->count;
+}
+
+/**
+ * Computes variables known to be non-nil at the beginning of blocks
+ * (forward dataflow, variable is non-nil if it is non-nil on all edges to block)
+ * @param variables variables of program
+ * @param blocks blocks of program
+ * @param count count of blocks
+ * @return sets of blocks (has to be freed) or NULL on allocation error
+*/
+static unsigned *nonnil_blocks_analyse(frame_variables_t *variables, live_block_t *blocks, unsigned count){
+    unsigned words = variables->words;
+    unsigned *sets = malloc((size_t)(3 * count) * words * sizeof(unsigned));
+    bool *reached = malloc(count * sizeof(bool));
+    if(sets == NULL || reached == NULL){
+        fprintf(stderr, "code_optimizer: nonnil_blocks_analyse: allocation failed.\n");
+        free(sets);
+        free(reached);
+        return NULL;
+    }
+
+    // blocks start with all variables known (nothing is known at the beginning of program and functions)
+    memset(sets, 0xff, (size_t)(3 * count) * words * sizeof(unsigned));
+    for(unsigned b = 0; b < count; b++){
+        blocks[b].in = sets + (size_t)(2 * b) * words;
+        blocks[b].out = sets + (size_t)(2 * b + 1) * words;
+    }
+    unsigned *edge = sets + (size_t)(2 * count) * words;
+
+    nonnil_state_t state;
+    bool changed = true;
+    while(changed){
+        changed = false;
+
+        memset(reached, 0, count * sizeof(bool));
+        for(unsigned b = 0; b < count; b++){
+            bool jump = false;
+            unsigned compared = nil_compared_variable(variables, &blocks[b], &jump);
+
+            for(unsigned s = 0; s < blocks[b].successor_count; s++){
+                // jump is the last successor of block
+                bool is_jump = s + 1 == blocks[b].successor_count && blocks[b].last->opcode != OP_LABEL &&
+                               instruction_has_label(blocks[b].last);
+                memcpy(edge, blocks[b].out, words * sizeof(unsigned));
+                if(compared < variables->count && is_jump == jump){
+                    set_add(edge, compared);
+                }
+
+                unsigned *in = blocks[blocks[b].successors[s]].in;
+                if(!reached[blocks[b].successors[s]]){
+                    memcpy(in, edge, words * sizeof(unsigned));
+                    reached[blocks[b].successors[s]] = true;
+                } else {
+                    for(unsigned w = 0; w < words; w++){
+                        in[w] &= edge[w];
+                    }
+                }
+            }
+        }
+
+        for(unsigned b = 0; b < count; b++){
+            if(b == 0 || !reached[b]){
+                memset(blocks[b].in, 0, words * sizeof(unsigned));
+            }
+
+            state.variables = edge;
+            state.top = 0;
+            memcpy(edge, blocks[b].in, words * sizeof(unsigned));
+            for(instruction_t *i = blocks[b].first; i != blocks[b].last->next; i = i->next){
+                nonnil_transfer(variables, i, &state);
+            }
+
+            if(memcmp(edge, blocks[b].out, words * sizeof(unsigned)) != 0){
+                memcpy(blocks[b].out, edge, words * sizeof(unsigned));
+                changed = true;
+            }
+        }
+    }
+
+    free(reached);
+    return sets;
+}
+
+/**
+ * Removes ?? operator, whose first operand is not nil (first operand is its result)
+ * @param code generated instructions
+ * @param pop first instruction of operator (POPS ?COALESCE_2)
+*/
+static void coalesce_remove(code_buffer_t *code, instruction_t *pop){
+    instruction_t *end = coalesce_sequence(pop)->next;
+    instruction_t *first = pop;
+
+    // pushed second operand is not needed, other computations of second operand are popped
+    if(pop->prev != NULL && pop->prev->opcode == OP_PUSHS){
+        first = pop->prev;
+    } else {
+        first = pop->next;
+    }
+
+    if(end != NULL && first->blank_line){
+        end->blank_line = true;
+    }
+
+    for(instruction_t *i = first; i != end;){
+        i = code_buffer_remove(code, i);
+    }
+}
+
+void code_optimizer_remove_nil_checks(code_buffer_t *code){
+    frame_variables_t variables;
+    if(!program_variables_collect(code, &variables)){
+        return;
+    }
+
+    unsigned count = 0;
+    live_block_t *blocks = live_blocks_create(code->head, NULL, &count);
+    unsigned *sets = blocks != NULL ? nonnil_blocks_analyse(&variables, blocks, count) : NULL;
+
+    unsigned size = 0;
+    for(instruction_t *i = code->head; i != NULL; i = i->next){
+        size += coalesce_sequence(i) != NULL;
+    }
+    instruction_t **removed = sets != NULL && size > 0 ? malloc(size * sizeof(instruction_t *)) : NULL;
+
+    // operators are removed after analysis (operator spans more blocks)
+    if(removed != NULL){
+        size = 0;
+        nonnil_state_t state;
+        for(unsigned b = 0; b < count; b++){
+            state.variables = blocks[b].out;
+            state.top = 0;
+            memcpy(state.variables, blocks[b].in, variables.words * sizeof(unsigned));
+
+            for(instruction_t *i = blocks[b].first; i != blocks[b].last->next; i = i->next){
+                if(state.top >= 2 && state.stack[state.top - 2] && coalesce_sequence(i) != NULL){
+                    removed[size++] = i;
+                }
+                nonnil_transfer(&variables, i, &state);
+            }
+        }
+
+        for(unsigned i = 0; i < size; i++){
+            coalesce_remove(code, removed[i]);
+        }
+    }
+
+    free(removed);
+    free(sets);
+    free(blocks);
+    frame_variables_dispose(&variables);
+}
+
+/**
+ * Checks if instruction has no effect outside of function (no input, output or user global variable)
+ * @param instruction checked instruction
+ * @return bool
+*/
+static bool instruction_is_pure(instruction_t *instruction){
+    switch(instruction->opcode){
+        case OP_READ:
+        case OP_WRITE:
+        case OP_EXIT:
+        case OP_BREAK:
+        case OP_DPRINT:
+        case OP_UNKNOWN:
+            return false;
+        default:
+            break;
+    }
+
+    // temporary global variables of generated code do not outlive statement
+    for(unsigned i = 0; i < instruction->operand_count; i++){
+        if(operand_in_frame(instruction->operands[i], "GF") &&
+           strncmp(instruction->operands[i], GLOBAL_TEMPORARY_PREFIX, strlen(GLOBAL_TEMPORARY_PREFIX)) != 0){
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Collects functions and finds pure functions (pure instructions, only pure functions are called)
+ * @param code generated instructions
+ * @param count count of found functions
+ * @param pure pure functions by indexes of regions (has to be freed)
+ * @return regions of functions (have to be freed) or NULL if there is no function or on allocation error
+*/
+static function_region_t *pure_functions_find(code_buffer_t *code, unsigned *count, bool **pure){
+    function_region_t region;
+    *count = 0;
+    for(instruction_t *i = code->head; i != NULL; i = function_region_at(i, &region) ? region.end : i->next){
+        *count += function_label_is(i);
+    }
+
+    function_region_t *regions = *count > 0 ? malloc(*count * sizeof(function_region_t)) : NULL;
+    *pure = *count > 0 ? malloc(*count * sizeof(bool)) : NULL;
+    if(regions == NULL || *pure == NULL){
+        free(regions);
+        free(*pure);
+        return NULL;
+    }
+
+    unsigned r = 0;
+    for(instruction_t *i = code->head; i != NULL;){
+        if(function_region_at(i, &regions[r])){
+            (*pure)[r] = true;
+            i = regions[r++].end;
+        } else {
+            i = i->next;
+        }
+    }
+
+    // function calling impure function is impure, repeated until nothing changes
+    bool changed = true;
+    while(changed){
+        changed = false;
+
+        for(r = 0; r < *count; r++){
+            for(instruction_t *i = regions[r].label->next; (*pure)[r] && i != regions[r].end; i = i->next){
+                bool pure_call = true;
+                if(i->opcode == OP_CALL){
+                    unsigned callee = 0;
+                    while(callee < *count && !instruction_is(regions[callee].label, OP_LABEL, i->operands[0])){
+                        callee++;
+                    }
+                    pure_call = callee < *count && (*pure)[callee];
+                }
+
+                if(!pure_call || !instruction_is_pure(i)){
+                    (*pure)[r] = false;
+                    changed = true;
+                }
+            }
+        }
+    }
+
+    return regions;
+}
+
+/**
+ * Creates program evaluating calls (temporary global variables, EXIT after evaluated call and pure functions)
+ * @param code generated instructions
+ * @param regions regions of functions
+ * @param pure pure functions
+ * @param count count of functions
+ * @param program created program
+ * @return EXIT instruction (evaluated call is inserted before it) or NULL on allocation error
+*/
+static instruction_t *evaluation_program_create(code_buffer_t *code, function_region_t *regions, bool *pure, unsigned count,
+                                                code_buffer_t *program){
+    code_buffer_init(program);
+
+    for(instruction_t *i = code->head; i != NULL; i = i->next){
+        if(i->opcode == OP_DEFVAR && strncmp(i->operands[0], GLOBAL_TEMPORARY_PREFIX, strlen(GLOBAL_TEMPORARY_PREFIX)) == 0){
+            instruction_t *copy = instruction_copy(i);
+            if(copy == NULL){
+                code_buffer_dispose(program);
+                return NULL;
+            }
+            code_buffer_append(program, copy);
+        }
+    }
+
+    instruction_t *exit = instruction_create(OP_EXIT, "int@0", NULL, NULL);
+    if(exit == NULL){
+        code_buffer_dispose(program);
+        return NULL;
+    }
+    code_buffer_append(program, exit);
+
+    for(unsigned r = 0; r < count; r++){
+        for(instruction_t *i = regions[r].label; pure[r] && i != regions[r].end; i = i->next){
+            instruction_t *copy = instruction_copy(i);
+            if(copy == NULL){
+                code_buffer_dispose(program);
+                return NULL;
+            }
+            code_buffer_append(program, copy);
+        }
+    }
+
+    return exit;
+}
+
+/**
+ * Evaluates call of pure function by interpreter
+ * @param program program evaluating calls
+ * @param exit EXIT instruction of program
+ * @param createframe first instruction of call (CREATEFRAME)
+ * @param call CALL instruction
+ * @param fuel remaining fuel of all evaluations
+ * @return constant returned by function (has to be freed) or NULL if call can not be evaluated
+*/
+static char *call_evaluate(code_buffer_t *program, instruction_t *exit, instruction_t *createframe, instruction_t *call,
+                           unsigned long long *fuel){
+    bool copied = true;
+    for(instruction_t *i = createframe; i != call->next && copied; i = i->next){
+        instruction_t *copy = instruction_copy(i);
+        if(copy != NULL){
+            code_buffer_insert_before(program, exit, copy);
+        }
+        copied = copy != NULL;
+    }
+
+    char *literal = NULL;
+    interpreter_program_t decoded;
+    interpreter_program_init(&decoded);
+
+    if(copied && interpreter_load_code(&decoded, program) == 0){
+        unsigned long long limit = *fuel < EVALUATE_CALL_FUEL ? *fuel : EVALUATE_CALL_FUEL;
+        unsigned long long remaining = limit;
+
+        if(interpreter_evaluate(&decoded, &remaining, &literal) != 0){
+            free(literal);
+            literal = NULL;
+        }
+        *fuel -= limit - remaining;
+    }
+
+    interpreter_program_dispose(&decoded);
+    while(exit->prev != NULL && exit->prev->opcode != OP_DEFVAR){
+        code_buffer_remove(program, exit->prev);
+    }
+
+    return literal;
+}
+
+void code_optimizer_evaluate_calls(code_buffer_t *code){
+    unsigned count = 0;
+    bool *pure = NULL;
+    function_region_t *regions = pure_functions_find(code, &count, &pure);
+    if(regions == NULL){
+        return;
+    }
+
+    code_buffer_t program;
+    instruction_t *exit = evaluation_program_create(code, regions, pure, count, &program);
+    unsigned long long fuel = EVALUATE_TOTAL_FUEL;
+
+    for(instruction_t *i = code->head; exit != NULL && fuel > 0 && i != NULL; i = i->next){
+        if(i->opcode != OP_CALL){
+            continue;
+        }
+
+        unsigned callee = 0;
+        while(callee < count && !instruction_is(regions[callee].label, OP_LABEL, i->operands[0])){
+            callee++;
+        }
+
+        // all arguments have to be constants
+        instruction_t *createframe = callee < count && pure[callee] ? call_frame(i) : NULL;
+        for(instruction_t *j = createframe; j != NULL && j != i; j = j->next){
+            if(j->opcode == OP_MOVE && !operand_is_constant(j->operands[1])){
+                createframe = NULL;
+            }
+        }
+
+        char *literal = createframe != NULL ? call_evaluate(&program, exit, createframe, i, &fuel) : NULL;
+        if(literal == NULL){
+            continue;
+        }
+
+        instruction_t *push = instruction_create(OP_PUSHS, literal, NULL, NULL);
+        free(literal);
+        if(push == NULL){
+            continue;
+        }
+
+        push->blank_line = createframe->blank_line;
+        push->line = i->line;
+        push->column = i->column;
+        code_buffer_insert_before(code, createframe, push);
+
+        instruction_t *end = i->next;
+        for(instruction_t *j = createframe; j != end;){
+            j = code_buffer_remove(code, j);
+        }
+        i = push;
+    }
+
+    if(exit != NULL){
+        code_buffer_dispose(&program);
+    }
+    free(regions);
+    free(pure);
+}
+
+/**
+ * Compares two constants at compile time
+ * @param opcode EQS, LTS or GTS
+ * @param first first operand
+ * @param second second operand
+ * @param result result of comparison
+ * @return false if result is not known (comparison of values can fail at runtime)
+*/
+static bool constants_compare(opcode_t opcode, const char *first, const char *second, bool *result){
+    const char *first_value = strchr(first, '@') + 1;
+    const char *second_value = strchr(second, '@') + 1;
+    size_t type_length = first_value - first;
+
+    if(type_length != (size_t)(second_value - second) || strncmp(first, second, type_length) != 0){
+        // nil is not equal to value of other type, other types can not be compared
+        if(opcode == OP_EQS && (strcmp(first, "nil@nil") == 0 || strcmp(second, "nil@nil") == 0)){
+            *result = false;
+            return true;
+        }
+        return false;
+    }
+
+    int order;
+    char *first_end;
+    char *second_end;
+
+    if(strncmp(first, "int@", 4) == 0){
+        long long a = strtoll(first_value, &first_end, 10);
+        long long b = strtoll(second_value, &second_end, 10);
+        order = (a > b) - (a < b);
+    } else if(strncmp(first, "float@", 6) == 0){
+        double a = strtod(first_value, &first_end);
+        double b = strtod(second_value, &second_end);
+        order = (a > b) - (a < b);
+    } else if(strncmp(first, "bool@", 5) == 0){
+        order = (strcmp(first_value, "true") == 0) - (strcmp(second_value, "true") == 0);
+        first_end = second_end = "";
+    } else if(opcode == OP_EQS && strcmp(first_value, second_value) == 0){
+        // same strings or nils
+        order = 0;
+        first_end = second_end = "";
+    } else {
+        return false;
+    }
+
+    if(*first_end != '\0' || *second_end != '\0'){
+        return false;
+    }
+
+    *result = opcode == OP_EQS ? order == 0 : (opcode == OP_LTS ? order < 0 : order > 0);
+    return true;
+}
+
+/**
+ * Replaces conditional jumps of cloned function comparing constants by JUMP or removes them
+ * (JUMPIFEQ/JUMPIFNEQ with operands or PUSHS, PUSHS, EQS/LTS/GTS, NOTS*, PUSHS bool@true, JUMPIFEQS/JUMPIFNEQS)
+ * @param code generated instructions
+ * @param clone label of cloned function
+*/
+static void clone_fold_branches(code_buffer_t *code, instruction_t *clone){
+    for(instruction_t *i = clone->next; i != NULL && !function_label_is(i);){
+        instruction_t *first = NULL;
+        opcode_t compare = OP_EQS;
+        bool jump_if_true = i->opcode == OP_JUMPIFEQ || i->opcode == OP_JUMPIFEQS;
+        const char *a = NULL;
+        const char *b = NULL;
+
+        if(i->opcode == OP_JUMPIFEQ || i->opcode == OP_JUMPIFNEQ){
+            first = i;
+            a = i->operands[1];
+            b = i->operands[2];
+        } else if((i->opcode == OP_JUMPIFEQS || i->opcode == OP_JUMPIFNEQS) && instruction_is(i->prev, OP_PUSHS, "bool@true")){
+            instruction_t *comparison = i->prev->prev;
+            while(comparison != NULL && comparison->opcode == OP_NOTS){
+                jump_if_true = !jump_if_true;
+                comparison = comparison->prev;
+            }
+
+            if(comparison != NULL &&
+               (comparison->opcode == OP_EQS || comparison->opcode == OP_LTS || comparison->opcode == OP_GTS) &&
+               comparison->prev->opcode == OP_PUSHS && comparison->prev->prev->opcode == OP_PUSHS){
+                first = comparison->prev->prev;
+                compare = comparison->opcode;
+                a = first->operands[0];
+                b = comparison->prev->operands[0];
+            }
+        }
+
+        bool result;
+        if(first == NULL || !operand_is_constant(a) || !operand_is_constant(b) || !constants_compare(compare, a, b, &result)){
+            i = i->next;
+            continue;
+        }
+
+        if(result == jump_if_true){
+            instruction_t *jump = instruction_create(OP_JUMP, i->operands[0], NULL, NULL);
+            if(jump == NULL){
+                i = i->next;
+                continue;
+            }
+            jump->blank_line = first->blank_line;
+            jump->line = i->line;
+            jump->column = i->column;
+            code_buffer_insert_after(code, i, jump);
+        }
+
+        instruction_t *following = i->next;
+        for(instruction_t *j = first; j != following;){
+            j = code_buffer_remove(code, j);
+        }
+        i = following;
+    }
+}
+
+/**
+ * Checks if label is target of jump in cloned function
+ * @param clone label of cloned function
+ * @param label name of label
+ * @return bool
+*/
+static bool clone_label_used(instruction_t *clone, const char *label){
+    for(instruction_t *i = clone->next; i != NULL && !function_label_is(i); i = i->next){
+        if(i->opcode != OP_LABEL && instruction_has_label(i) && strcmp(i->operands[0], label) == 0){
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * Removes code of cloned function, which can not be reached after folding of jumps
+ * (instructions after JUMP, RETURN or EXIT, jumps to the next instruction and unused labels,
+ *  labels of loops and jumps to them are kept for optimizations of loops)
+ * @param code generated instructions
+ * @param clone label of cloned function
+*/
+static void clone_remove_unreachable(code_buffer_t *code, instruction_t *clone){
+    bool changed = true;
+    while(changed){
+        changed = false;
+
+        for(instruction_t *i = clone->next; i != NULL && !function_label_is(i);){
+            bool ends = i->opcode == OP_JUMP || i->opcode == OP_RETURN || i->opcode == OP_EXIT;
+            bool loop = instruction_has_label(i) && strncmp(i->operands[0], LOOP_PREFIX, strlen(LOOP_PREFIX)) == 0;
+
+            if(ends && i->next != NULL && i->next->opcode != OP_LABEL){
+                code_buffer_remove(code, i->next);
+            } else if(i->opcode == OP_JUMP && !loop && instruction_is(i->next, OP_LABEL, i->operands[0])){
+                i = code_buffer_remove(code, i);
+            } else if(i->opcode == OP_LABEL && !loop && !clone_label_used(clone, i->operands[0])){
+                i = code_buffer_remove(code, i);
+            } else {
+                i = i->next;
+                continue;
+            }
+
+            changed = true;
+        }
+    }
+}
+
+/**
+ * Collects constant arguments of calls of functions, which can be cloned
+ * (function is not recursive, clone or larger than CLONE_MAX_SIZE and does not change parameter)
+ * @param code generated instructions
+ * @param symtable global symtable with information about recursion
+ * @param count count of found candidates
+ * @return candidates (have to be freed) or NULL if there is no candidate or on allocation error
+*/
+static clone_candidate_t *clone_candidates_collect(code_buffer_t *code, symtab_t *symtable, unsigned *count){
+    clone_candidate_t *candidates = NULL;
+    unsigned size = 0;
+    function_region_t region;
+    *count = 0;
+
+    for(instruction_t *i = code->head; i != NULL; i = i->next){
+        instruction_t *createframe = i->opcode == OP_CALL ? call_frame(i) : NULL;
+        if(createframe == NULL || !function_region_find(code, i->operands[0], &region) || strchr(region.name, '$') != NULL){
+            continue;
+        }
+
+        symtab_item_t *item = function_item(&region, symtable);
+        if(item == NULL || item->is_recursive || region.label->next == NULL || region.label->next->opcode != OP_PUSHFRAME){
+            continue;
+        }
+
+        unsigned function_size = 0;
+        for(instruction_t *j = region.label; j != region.end; j = j->next){
+            function_size++;
+        }
+        if(function_size > CLONE_MAX_SIZE){
+            continue;
+        }
+
+        for(instruction_t *j = createframe->next; j != i; j = j->next){
+            char parameter[64];
+            snprintf(parameter, sizeof(parameter), "LF@%s", j->operands[0] + 3);
+            if(j->opcode != OP_MOVE || !operand_is_constant(j->operands[1]) || parameter_is_written(region.label->next, parameter)){
+                continue;
+            }
+
+            unsigned c = 0;
+            while(c < *count && (strcmp(candidates[c].label, i->operands[0]) != 0 ||
+                                 strcmp(candidates[c].argument, j->operands[0]) != 0 ||
+                                 strcmp(candidates[c].constant, j->operands[1]) != 0)){
+                c++;
+            }
+
+            if(c == *count){
+                if(*count == size){
+                    size = size == 0 ? 8 : size * 2;
+                    clone_candidate_t *resized = realloc(candidates, size * sizeof(clone_candidate_t));
+                    if(resized == NULL){
+                        fprintf(stderr, "code_optimizer: clone_candidates_collect: realloc failed.\n");
+                        free(candidates);
+                        *count = 0;
+                        return NULL;
+                    }
+                    candidates = resized;
+                }
+
+                candidates[c].label = i->operands[0];
+                candidates[c].argument = j->operands[0];
+                candidates[c].constant = j->operands[1];
+                candidates[c].calls = 0;
+                candidates[c].size = function_size;
+                (*count)++;
+            }
+
+            candidates[c].calls++;
+        }
+    }
+
+    return candidates;
+}
+
+/**
+ * Appends copy of function with constant instead of parameter to the end of code
+ * @param code generated instructions
+ * @param region region of cloned function
+ * @param parameter replaced parameter (LF@??_n)
+ * @param constant value of parameter
+ * @return label of clone or NULL on allocation error
+*/
+static instruction_t *function_clone(code_buffer_t *code, function_region_t *region, const char *parameter, const char *constant){
+    // suffix differs from suffix of inlined calls, so profile tells clones from inlined code
+    unsigned id = clone_id++;
+    instruction_t *clone = NULL;
+    instruction_t *last = code->tail; // copies are appended after the last function
+
+    for(instruction_t *i = region->label; i != region->end; i = i->next){
+        instruction_t *copy = instruction_copy(i);
+        char *renamed = copy != NULL && instruction_has_label(copy) ? key_create("%s$c%u", copy->operands[0], id) : NULL;
+
+        if(copy == NULL || (instruction_has_label(copy) && renamed == NULL)){
+            instruction_free(copy);
+            while(clone != NULL){
+                clone = code_buffer_remove(code, clone);
+            }
+            return NULL;
+        }
+
+        if(renamed != NULL){
+            instruction_set_operand(copy, 0, renamed);
+            free(renamed);
+        }
+
+        bool writes = copy->opcode < OP_UNKNOWN && instruction_table[copy->opcode].writes_target;
+        for(unsigned j = writes ? 1 : 0; j < copy->operand_count; j++){
+            if(strcmp(copy->operands[j], parameter) == 0){
+                instruction_set_operand(copy, j, constant);
+            }
+        }
+
+        code_buffer_append(code, copy);
+        if(clone == NULL){
+            clone = copy;
+        }
+        if(i == last){
+            break;
+        }
+    }
+
+    return clone;
+}
+
+/**
+ * Redirects calls passing constant argument to clone and removes the argument
+ * @param code generated instructions
+ * @param clone label of clone
+ * @param label label of cloned function
+ * @param argument removed argument (TF@??_n)
+ * @param constant value of argument
+*/
+static void clone_calls_redirect(code_buffer_t *code, instruction_t *clone, const char *label, const char *argument,
+                                 const char *constant){
+    for(instruction_t *i = code->head; i != NULL; i = i->next){
+        instruction_t *createframe = instruction_is(i, OP_CALL, label) ? call_frame(i) : NULL;
+
+        for(instruction_t *j = createframe; j != NULL && j != i; j = j->next){
+            if(j->opcode == OP_MOVE && strcmp(j->operands[0], argument) == 0 && strcmp(j->operands[1], constant) == 0){
+                code_buffer_remove(code, j->prev);
+                code_buffer_remove(code, j);
+                instruction_set_operand(i, 0, clone->operands[0]);
+                break;
+            }
+        }
+    }
+}
+
+void code_optimizer_clone_functions(code_buffer_t *code, symtab_t *symtable){
+    unsigned budget = CLONE_BUDGET;
+
+    while(true){
+        unsigned count = 0;
+        clone_candidate_t *candidates = clone_candidates_collect(code, symtable, &count);
+
+        // argument passed by the most calls, which fits into remaining budget
+        clone_candidate_t *best = NULL;
+        for(unsigned c = 0; c < count; c++){
+            if(candidates[c].calls >= CLONE_MIN_CALLS && candidates[c].size <= budget &&
+               (best == NULL || candidates[c].calls > best->calls)){
+                best = &candidates[c];
+            }
+        }
+
+        if(best == NULL){
+            free(candidates);
+            return;
+        }
+
+        // operands of calls are changed by redirection
+        budget -= best->size;
+        char *label = key_create("%s", best->label);
+        char *argument = key_create("%s", best->argument);
+        char *parameter = key_create("LF@%s", best->argument + 3);
+        char *constant = key_create("%s", best->constant);
+        free(candidates);
+
+        function_region_t region;
+        instruction_t *clone = NULL;
+        if(label != NULL && argument != NULL && parameter != NULL && constant != NULL &&
+           function_region_find(code, label, &region)){
+            clone = function_clone(code, &region, parameter, constant);
+        }
+
+        if(clone != NULL){
+            clone_fold_branches(code, clone);
+            clone_remove_unreachable(code, clone);
+            clone_calls_redirect(code, clone, label, argument, constant);
+        }
+
+        free(label);
+        free(argument);
+        free(parameter);
+        free(constant);
+
+        if(clone == NULL){
+            return;
+        }
+    }
+}
+
+void code_optimizer_run(code_buffer_t *code, symtab_t *symtable){
+    code_optimizer_evaluate_calls(code);
+
+    for(unsigned round = 0; round < INLINE_ROUNDS; round++){
+        if(code_optimizer_inline(code, symtable) == 0){
+            break;
+        }
+    }
+
+    code_optimizer_clone_functions(code, symtable);
+    code_optimizer_remove_unused_functions(code);
+    code_optimizer_remove_nil_checks(code);
+    code_optimizer_propagate_copies(code);
+    code_optimizer_eliminate_dead_stores(code);
+    code_optimizer_eliminate_tail_calls(code, symtable);
+    code_optimizer_eliminate_common_subexpressions(code);
+    code_optimizer_hoist_invariants(code);
+    code_optimizer_rotate_loops(code);
+    code_optimizer_direct_branches(code);
+    code_optimizer_share_frame_slots(code);
+    code_optimizer_select_instructions(code);
+}
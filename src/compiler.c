@@ -14,9 +14,35 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include "parser.h"
 
-int main()
+int main(int argc, char** argv)
 {
+    /* --line-map FILE writes source positions of generated instructions to FILE */
+    /* --binary FILE writes generated code also as binary container to FILE */
+    /* --compact gives short names to variables and drops blank lines, --name-map FILE writes their original names */
+    bool compact = false;
+    const char* names = NULL;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--line-map") == 0 && i + 1 < argc) {
+            code_generator_line_map(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--binary") == 0 && i + 1 < argc) {
+            code_generator_binary(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--compact") == 0) {
+            compact = true;
+        }
+        else if (strcmp(argv[i], "--name-map") == 0 && i + 1 < argc) {
+            names = argv[++i];
+        }
+        else {
+            fprintf(stderr, "Usage: %s [--line-map FILE] [--binary FILE] [--compact [--name-map FILE]] < program.swift\n", argv[0]);
+            return ERR_INTERNAL;
+        }
+    }
+    code_generator_compact(compact, names);
+
     return parse();
 }
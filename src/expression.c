@@ -30,9 +30,9 @@
 #define PRINT_STACK(stack)
 #endif
 
-#define EMPTY_TOKEN(eol)                \
-    {                                   \
-        eol, TOKEN_UNDEFINED, { false } \
+#define EMPTY_TOKEN(eol)                                 \
+    {                                                    \
+        eol, TOKEN_UNDEFINED, { false }, { 0, 0, 0, 0 } \
     }
 
 #define DEFINE_EXPR_SYMBOL                      \
@@ -1147,7 +1147,7 @@ symstack_data_t process_relational_operation(symbol_arr_t *sym_arr, Parser *p)
         }
 
         // ?? generation
-        code_generator_nil_check(p->cond_uid);
+        code_generator_nil_check(p->cond_uid, compare_operand_with_type(&first_operand,nil));
         p->cond_uid += 1;
 
         expr_symbol.expr_res.nilable = false;
@@ -0,0 +1,2536 @@
+/**
+ * @name IFJ23
+ * @file interpreter.c
+ * @brief Interpreter of IFJcode23 programs with threaded dispatch over pre-decoded instructions
+ * @author Marie Kolarikova <xkolar77@stud.fit.vutbr.cz>
+ * @date 3.12.2023
+ **/
+
+#include "interpreter.h"
+#include "code_binary.h"
+#include "error.h"
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <ctype.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(__GNUC__) && !defined(INTERPRETER_SWITCH)
+// addresses of labels (GNU C extension) let every instruction jump directly to code of the next one
+#define INTERPRETER_THREADED
+// pedantic warnings about the extension are disabled only around the table of handlers and jumps to them
+#define PEDANTIC_OFF _Pragma("GCC diagnostic push") _Pragma("GCC diagnostic ignored \"-Wpedantic\"")
+#define PEDANTIC_ON _Pragma("GCC diagnostic pop")
+#endif
+
+#define HEADER ".IFJcode23"
+#define FRAME_INITIAL_CAPACITY 16 // power of 2
+#define STACK_INITIAL_CAPACITY 64
+#define NAMES_INITIAL_CAPACITY 64 // power of 2
+
+/**
+ * @brief kind of operand expected by instruction
+ */
+typedef enum {
+    ARGUMENT_VARIABLE,
+    ARGUMENT_SYMBOL,
+    ARGUMENT_LABEL,
+    ARGUMENT_TYPE
+} argument_kind_t;
+
+static const argument_kind_t argument_kinds[OP_UNKNOWN][MAX_OPERANDS] = {
+    [OP_MOVE]       = {ARGUMENT_VARIABLE, ARGUMENT_SYMBOL},
+    [OP_DEFVAR]     = {ARGUMENT_VARIABLE},
+    [OP_CALL]       = {ARGUMENT_LABEL},
+    [OP_PUSHS]      = {ARGUMENT_SYMBOL},
+    [OP_POPS]       = {ARGUMENT_VARIABLE},
+    [OP_ADD]        = {ARGUMENT_VARIABLE, ARGUMENT_SYMBOL, ARGUMENT_SYMBOL},
+    [OP_SUB]        = {ARGUMENT_VARIABLE, ARGUMENT_SYMBOL, ARGUMENT_SYMBOL},
+    [OP_MUL]        = {ARGUMENT_VARIABLE, ARGUMENT_SYMBOL, ARGUMENT_SYMBOL},
+    [OP_DIV]        = {ARGUMENT_VARIABLE, ARGUMENT_SYMBOL, ARGUMENT_SYMBOL},
+    [OP_IDIV]       = {ARGUMENT_VARIABLE, ARGUMENT_SYMBOL, ARGUMENT_SYMBOL},
+    [OP_LT]         = {ARGUMENT_VARIABLE, ARGUMENT_SYMBOL, ARGUMENT_SYMBOL},
+    [OP_GT]         = {ARGUMENT_VARIABLE, ARGUMENT_SYMBOL, ARGUMENT_SYMBOL},
+    [OP_EQ]         = {ARGUMENT_VARIABLE, ARGUMENT_SYMBOL, ARGUMENT_SYMBOL},
+    [OP_AND]        = {ARGUMENT_VARIABLE, ARGUMENT_SYMBOL, ARGUMENT_SYMBOL},
+    [OP_OR]         = {ARGUMENT_VARIABLE, ARGUMENT_SYMBOL, ARGUMENT_SYMBOL},
+    [OP_NOT]        = {ARGUMENT_VARIABLE, ARGUMENT_SYMBOL},
+    [OP_INT2FLOAT]  = {ARGUMENT_VARIABLE, ARGUMENT_SYMBOL},
+    [OP_FLOAT2INT]  = {ARGUMENT_VARIABLE, ARGUMENT_SYMBOL},
+    [OP_INT2CHAR]   = {ARGUMENT_VARIABLE, ARGUMENT_SYMBOL},
+    [OP_STRI2INT]   = {ARGUMENT_VARIABLE, ARGUMENT_SYMBOL, ARGUMENT_SYMBOL},
+    [OP_READ]       = {ARGUMENT_VARIABLE, ARGUMENT_TYPE},
+    [OP_WRITE]      = {ARGUMENT_SYMBOL},
+    [OP_CONCAT]     = {ARGUMENT_VARIABLE, ARGUMENT_SYMBOL, ARGUMENT_SYMBOL},
+    [OP_STRLEN]     = {ARGUMENT_VARIABLE, ARGUMENT_SYMBOL},
+    [OP_GETCHAR]    = {ARGUMENT_VARIABLE, ARGUMENT_SYMBOL, ARGUMENT_SYMBOL},
+    [OP_SETCHAR]    = {ARGUMENT_VARIABLE, ARGUMENT_SYMBOL, ARGUMENT_SYMBOL},
+    [OP_TYPE]       = {ARGUMENT_VARIABLE, ARGUMENT_SYMBOL},
+    [OP_LABEL]      = {ARGUMENT_LABEL},
+    [OP_JUMP]       = {ARGUMENT_LABEL},
+    [OP_JUMPIFEQ]   = {ARGUMENT_LABEL, ARGUMENT_SYMBOL, ARGUMENT_SYMBOL},
+    [OP_JUMPIFNEQ]  = {ARGUMENT_LABEL, ARGUMENT_SYMBOL, ARGUMENT_SYMBOL},
+    [OP_JUMPIFEQS]  = {ARGUMENT_LABEL},
+    [OP_JUMPIFNEQS] = {ARGUMENT_LABEL},
+    [OP_EXIT]       = {ARGUMENT_SYMBOL},
+    [OP_DPRINT]     = {ARGUMENT_SYMBOL},
+};
+
+/**
+ * @brief frame of variables (open addressing table indexed by ids of names)
+ */
+typedef struct interpreter_frame {
+    unsigned *names;
+    interpreter_value_t *values;
+    unsigned count;
+    unsigned capacity;
+    struct interpreter_frame *next; // next unused frame
+} interpreter_frame_t;
+
+/**
+ * @brief state of running program
+ */
+typedef struct interpreter {
+    interpreter_value_t *globals;
+    interpreter_value_t *stack;     // data stack
+    unsigned stack_count;
+    unsigned stack_capacity;
+    unsigned *calls;                // return addresses
+    unsigned long long *call_starts; // count of dispatches before call (profiling)
+    unsigned *call_active;          // count of unfinished calls of every CALL instruction (profiling)
+    unsigned call_count;
+    unsigned call_capacity;
+    interpreter_frame_t **frames;   // stack of local frames
+    unsigned frame_count;
+    unsigned frame_capacity;
+    interpreter_frame_t *temporary;
+    interpreter_frame_t *unused;    // disposed frames reused by CREATEFRAME
+    unsigned long long fuel;        // remaining count of executed jumps and calls
+    size_t string_limit;            // maximal length of string created by CONCAT
+    int error;
+} interpreter_t;
+
+/**
+ * @brief state of decoding of source code
+ */
+typedef struct loader {
+    interpreter_program_t *program;
+    unsigned *label_positions;      // indexes of labeled instructions by ids of labels
+    unsigned label_capacity;
+    unsigned line;
+    bool header;
+} loader_t;
+
+/* ---------------------------------------------------------------- strings */
+
+/**
+ * Creates string with reference count 1
+ * @param chars copied chars
+ * @param length count of chars
+ * @return new string or NULL on allocation error
+*/
+static interpreter_string_t *string_create(const char *chars, size_t length){
+    interpreter_string_t *string = malloc(sizeof(interpreter_string_t));
+    if(string == NULL){
+        return NULL;
+    }
+
+    string->chars = malloc(length + 1);
+    if(string->chars == NULL){
+        free(string);
+        return NULL;
+    }
+
+    memcpy(string->chars, chars, length);
+    string->chars[length] = '\0';
+    string->length = length;
+    string->capacity = length;
+    string->references = 1;
+    return string;
+}
+
+/**
+ * Drops one reference to string, string is freed with the last one
+ * @param string released string
+*/
+static void string_release(interpreter_string_t *string){
+    if(--string->references == 0){
+        free(string->chars);
+        free(string);
+    }
+}
+
+/**
+ * Appends chars to string in place (string has only one owner)
+ * @param string changed string
+ * @param chars appended chars
+ * @param length count of appended chars
+ * @return false on allocation error
+*/
+static bool string_append(interpreter_string_t *string, const char *chars, size_t length){
+    if(string->length + length > string->capacity){
+        size_t capacity = string->capacity * 2 > string->length + length ? string->capacity * 2 : string->length + length;
+        char *resized = realloc(string->chars, capacity + 1);
+        if(resized == NULL){
+            return false;
+        }
+        string->chars = resized;
+        string->capacity = capacity;
+    }
+
+    memcpy(string->chars + string->length, chars, length);
+    string->length += length;
+    string->chars[string->length] = '\0';
+    return true;
+}
+
+/* ----------------------------------------------------------------- values */
+
+/**
+ * Drops reference held by value
+ * @param value released value
+*/
+static void value_release(interpreter_value_t *value){
+    if(value->type == VALUE_STRING){
+        string_release(value->data.string_val);
+    }
+}
+
+/**
+ * Copies value to variable (previous value of variable is released)
+ * @param target variable
+ * @param value copied value
+*/
+static void value_copy(interpreter_value_t *target, const interpreter_value_t *value){
+    if(value->type == VALUE_STRING){
+        value->data.string_val->references++;
+    }
+    value_release(target);
+    *target = *value;
+}
+
+/**
+ * Moves value to variable (previous value of variable is released)
+ * @param target variable
+ * @param value moved value (reference is taken over by variable)
+*/
+static void value_move(interpreter_value_t *target, const interpreter_value_t *value){
+    value_release(target);
+    *target = *value;
+}
+
+/**
+ * Creates string value
+ * @param value target value
+ * @param chars chars of string
+ * @param length count of chars
+ * @return 0 or ERR_INTERNAL
+*/
+static int value_string(interpreter_value_t *value, const char *chars, size_t length){
+    value->type = VALUE_STRING;
+    value->data.string_val = string_create(chars, length);
+    return value->data.string_val == NULL ? ERR_INTERNAL : 0;
+}
+
+/**
+ * Compares values of the same type
+ * @return negative, zero or positive number as strcmp()
+*/
+static int value_order(const interpreter_value_t *a, const interpreter_value_t *b){
+    switch(a->type){
+        case VALUE_INT:
+            return (a->data.int_val > b->data.int_val) - (a->data.int_val < b->data.int_val);
+        case VALUE_FLOAT:
+            return (a->data.float_val > b->data.float_val) - (a->data.float_val < b->data.float_val);
+        case VALUE_BOOL:
+            return (int)a->data.bool_val - (int)b->data.bool_val;
+        case VALUE_STRING: {
+            interpreter_string_t *x = a->data.string_val;
+            interpreter_string_t *y = b->data.string_val;
+            int order = memcmp(x->chars, y->chars, x->length < y->length ? x->length : y->length);
+            if(order != 0){
+                return order;
+            }
+            return (x->length > y->length) - (x->length < y->length);
+        }
+        default:
+            return 0;
+    }
+}
+
+/**
+ * Computes ADD, SUB, MUL, DIV or IDIV
+ * @param opcode operation
+ * @param a first operand
+ * @param b second operand
+ * @param result value of result
+ * @return 0 or error code of interpreter
+*/
+static int value_arithmetic(opcode_t opcode, const interpreter_value_t *a, const interpreter_value_t *b, interpreter_value_t *result){
+    if(a->type != b->type){
+        return ERR_RUN_OPERAND_TYPE;
+    }
+
+    if(a->type == VALUE_INT && opcode != OP_DIV){
+        // integers wrap around as 64-bit values of IFJcode23
+        unsigned long long x = (unsigned long long)a->data.int_val;
+        unsigned long long y = (unsigned long long)b->data.int_val;
+        result->type = VALUE_INT;
+
+        switch(opcode){
+            case OP_ADD:
+                result->data.int_val = (long long)(x + y);
+                break;
+            case OP_SUB:
+                result->data.int_val = (long long)(x - y);
+                break;
+            case OP_MUL:
+                result->data.int_val = (long long)(x * y);
+                break;
+            default: {
+                long long dividend = a->data.int_val;
+                long long divisor = b->data.int_val;
+                if(divisor == 0){
+                    return ERR_RUN_OPERAND_VALUE;
+                }
+                if(dividend == LLONG_MIN && divisor == -1){
+                    result->data.int_val = LLONG_MIN;
+                    break;
+                }
+                // quotient is rounded down
+                long long quotient = dividend / divisor;
+                if(dividend % divisor != 0 && (dividend < 0) != (divisor < 0)){
+                    quotient--;
+                }
+                result->data.int_val = quotient;
+                break;
+            }
+        }
+        return 0;
+    }
+
+    if(a->type == VALUE_FLOAT && opcode != OP_IDIV){
+        double x = a->data.float_val;
+        double y = b->data.float_val;
+        result->type = VALUE_FLOAT;
+
+        switch(opcode){
+            case OP_ADD:
+                result->data.float_val = x + y;
+                break;
+            case OP_SUB:
+                result->data.float_val = x - y;
+                break;
+            case OP_MUL:
+                result->data.float_val = x * y;
+                break;
+            default:
+                if(y == 0.0){
+                    return ERR_RUN_OPERAND_VALUE;
+                }
+                result->data.float_val = x / y;
+                break;
+        }
+        return 0;
+    }
+
+    return ERR_RUN_OPERAND_TYPE;
+}
+
+/**
+ * Computes LT, GT or EQ (only EQ accepts nil with other type)
+ * @param opcode operation
+ * @param a first operand
+ * @param b second operand
+ * @param result bool value of result
+ * @return 0 or ERR_RUN_OPERAND_TYPE
+*/
+static int value_compare(opcode_t opcode, const interpreter_value_t *a, const interpreter_value_t *b, interpreter_value_t *result){
+    result->type = VALUE_BOOL;
+
+    if(opcode == OP_EQ && (a->type == VALUE_NIL || b->type == VALUE_NIL)){
+        result->data.bool_val = a->type == b->type;
+        return 0;
+    }
+
+    if(a->type != b->type || a->type == VALUE_NIL){
+        return ERR_RUN_OPERAND_TYPE;
+    }
+
+    int order = value_order(a, b);
+    switch(opcode){
+        case OP_LT:
+            result->data.bool_val = order < 0;
+            break;
+        case OP_GT:
+            result->data.bool_val = order > 0;
+            break;
+        default:
+            result->data.bool_val = order == 0;
+            break;
+    }
+    return 0;
+}
+
+/**
+ * Computes AND, OR or NOT
+ * @param opcode operation
+ * @param a first operand
+ * @param b second operand (ignored by NOT)
+ * @param result bool value of result
+ * @return 0 or ERR_RUN_OPERAND_TYPE
+*/
+static int value_logic(opcode_t opcode, const interpreter_value_t *a, const interpreter_value_t *b, interpreter_value_t *result){
+    if(a->type != VALUE_BOOL || (opcode != OP_NOT && b->type != VALUE_BOOL)){
+        return ERR_RUN_OPERAND_TYPE;
+    }
+
+    result->type = VALUE_BOOL;
+    switch(opcode){
+        case OP_AND:
+            result->data.bool_val = a->data.bool_val && b->data.bool_val;
+            break;
+        case OP_OR:
+            result->data.bool_val = a->data.bool_val || b->data.bool_val;
+            break;
+        default:
+            result->data.bool_val = !a->data.bool_val;
+            break;
+    }
+    return 0;
+}
+
+/**
+ * Computes INT2FLOAT, FLOAT2INT, INT2CHAR or STRI2INT
+ * @param opcode operation
+ * @param a first operand
+ * @param b second operand (index of STRI2INT)
+ * @param result value of result
+ * @return 0 or error code of interpreter
+*/
+static int value_convert(opcode_t opcode, const interpreter_value_t *a, const interpreter_value_t *b, interpreter_value_t *result){
+    switch(opcode){
+        case OP_INT2FLOAT:
+            if(a->type != VALUE_INT){
+                return ERR_RUN_OPERAND_TYPE;
+            }
+            result->type = VALUE_FLOAT;
+            result->data.float_val = (double)a->data.int_val;
+            return 0;
+        case OP_FLOAT2INT:
+            if(a->type != VALUE_FLOAT){
+                return ERR_RUN_OPERAND_TYPE;
+            }
+            if(!(a->data.float_val > (double)LLONG_MIN && a->data.float_val < (double)LLONG_MAX)){
+                return ERR_RUN_OPERAND_VALUE;
+            }
+            result->type = VALUE_INT;
+            result->data.int_val = (long long)a->data.float_val;
+            return 0;
+        case OP_INT2CHAR: {
+            if(a->type != VALUE_INT){
+                return ERR_RUN_OPERAND_TYPE;
+            }
+            if(a->data.int_val < 0 || a->data.int_val > UCHAR_MAX){
+                return ERR_RUN_STRING;
+            }
+            char c = (char)a->data.int_val;
+            return value_string(result, &c, 1);
+        }
+        default:
+            if(a->type != VALUE_STRING || b->type != VALUE_INT){
+                return ERR_RUN_OPERAND_TYPE;
+            }
+            if(b->data.int_val < 0 || (unsigned long long)b->data.int_val >= a->data.string_val->length){
+                return ERR_RUN_STRING;
+            }
+            result->type = VALUE_INT;
+            result->data.int_val = (unsigned char)a->data.string_val->chars[b->data.int_val];
+            return 0;
+    }
+}
+
+/**
+ * Writes value in format of WRITE
+ * @param value written value
+ * @param output output stream
+*/
+static void value_write(const interpreter_value_t *value, FILE *output){
+    switch(value->type){
+        case VALUE_INT:
+            fprintf(output, "%lld", value->data.int_val);
+            break;
+        case VALUE_FLOAT:
+            fprintf(output, "%a", value->data.float_val);
+            break;
+        case VALUE_BOOL:
+            fputs(value->data.bool_val ? "true" : "false", output);
+            break;
+        case VALUE_STRING:
+            fwrite(value->data.string_val->chars, 1, value->data.string_val->length, output);
+            break;
+        default:
+            break;
+    }
+}
+
+/**
+ * Creates IFJcode23 constant of value (int@1, string@a\032b ...)
+ * @param value converted value
+ * @return new string (has to be freed) or NULL for uninitialized value or on allocation error
+*/
+static char *value_literal(const interpreter_value_t *value){
+    char number[64];
+    const char *prefix = number;
+    size_t length = 0;
+
+    switch(value->type){
+        case VALUE_NIL:
+            prefix = "nil@nil";
+            break;
+        case VALUE_INT:
+            snprintf(number, sizeof(number), "int@%lld", value->data.int_val);
+            break;
+        case VALUE_FLOAT:
+            snprintf(number, sizeof(number), "float@%a", value->data.float_val);
+            break;
+        case VALUE_BOOL:
+            prefix = value->data.bool_val ? "bool@true" : "bool@false";
+            break;
+        case VALUE_STRING:
+            prefix = "string@";
+            length = value->data.string_val->length;
+            break;
+        default:
+            return NULL;
+    }
+
+    // chars are escaped as \ddd at most
+    char *literal = malloc(strlen(prefix) + 4 * length + 1);
+    if(literal == NULL){
+        return NULL;
+    }
+
+    char *end = literal + strlen(strcpy(literal, prefix));
+    for(size_t i = 0; i < length; i++){
+        unsigned char c = (unsigned char)value->data.string_val->chars[i];
+        if(c <= 32 || c == '#' || c == '\\'){
+            end += sprintf(end, "\\%03u", c);
+        } else {
+            *end++ = (char)c;
+        }
+    }
+    *end = '\0';
+
+    return literal;
+}
+
+/**
+ * Reads value of given type from one line of input (nil if line is missing or invalid)
+ * @param input input stream
+ * @param type type of read value
+ * @param value read value
+ * @return 0 or ERR_INTERNAL
+*/
+static int value_read(FILE *input, value_type_t type, interpreter_value_t *value){
+    size_t capacity = 64;
+    size_t length = 0;
+    char *line = malloc(capacity);
+    if(line == NULL){
+        return ERR_INTERNAL;
+    }
+
+    int c = EOF;
+    while((c = fgetc(input)) != EOF && c != '\n'){
+        if(length + 1 >= capacity){
+            char *resized = realloc(line, capacity * 2);
+            if(resized == NULL){
+                free(line);
+                return ERR_INTERNAL;
+            }
+            line = resized;
+            capacity *= 2;
+        }
+        line[length++] = (char)c;
+    }
+    line[length] = '\0';
+
+    int result = 0;
+    char *end = NULL;
+    value->type = VALUE_NIL;
+
+    if(c == EOF && length == 0){
+        // missing line
+    } else if(type == VALUE_STRING){
+        result = value_string(value, line, length);
+    } else if(type == VALUE_BOOL){
+        if(strcmp(line, "true") == 0 || strcmp(line, "false") == 0){
+            value->type = VALUE_BOOL;
+            value->data.bool_val = line[0] == 't';
+        }
+    } else if(length > 0 && !isspace((unsigned char)line[0])){
+        // whole line has to be number
+        if(type == VALUE_INT){
+            long long number = strtoll(line, &end, 0);
+            if(*end == '\0'){
+                value->type = VALUE_INT;
+                value->data.int_val = number;
+            }
+        } else {
+            double number = strtod(line, &end);
+            if(*end == '\0'){
+                value->type = VALUE_FLOAT;
+                value->data.float_val = number;
+            }
+        }
+    }
+
+    free(line);
+    return result;
+}
+
+/* ----------------------------------------------------------------- frames */
+
+/**
+ * Gets slot of name in table of given capacity
+ * @param name id of name
+ * @param capacity capacity of table (power of 2)
+*/
+static unsigned frame_hash(unsigned name, unsigned capacity){
+    return (name * 2654435761u) & (capacity - 1);
+}
+
+/**
+ * Takes empty frame (disposed frames are reused)
+ * @param state state of interpreter
+ * @return frame or NULL on allocation error
+*/
+static interpreter_frame_t *frame_create(interpreter_t *state){
+    interpreter_frame_t *frame = state->unused;
+    if(frame != NULL){
+        state->unused = frame->next;
+        return frame;
+    }
+
+    frame = malloc(sizeof(interpreter_frame_t));
+    if(frame == NULL){
+        return NULL;
+    }
+
+    frame->names = malloc(FRAME_INITIAL_CAPACITY * sizeof(unsigned));
+    frame->values = malloc(FRAME_INITIAL_CAPACITY * sizeof(interpreter_value_t));
+    if(frame->names == NULL || frame->values == NULL){
+        free(frame->names);
+        free(frame->values);
+        free(frame);
+        return NULL;
+    }
+
+    for(unsigned i = 0; i < FRAME_INITIAL_CAPACITY; i++){
+        frame->names[i] = INTERPRETER_NO_INDEX;
+    }
+    frame->count = 0;
+    frame->capacity = FRAME_INITIAL_CAPACITY;
+    return frame;
+}
+
+/**
+ * Releases variables of frame and keeps frame for reuse
+ * @param state state of interpreter
+ * @param frame disposed frame
+*/
+static void frame_dispose(interpreter_t *state, interpreter_frame_t *frame){
+    for(unsigned i = 0; i < frame->capacity && frame->count > 0; i++){
+        if(frame->names[i] != INTERPRETER_NO_INDEX){
+            value_release(&frame->values[i]);
+            frame->names[i] = INTERPRETER_NO_INDEX;
+            frame->count--;
+        }
+    }
+
+    frame->next = state->unused;
+    state->unused = frame;
+}
+
+/**
+ * Frees memory of frame
+ * @param frame freed frame (without variables)
+*/
+static void frame_free(interpreter_frame_t *frame){
+    free(frame->names);
+    free(frame->values);
+    free(frame);
+}
+
+/**
+ * Finds variable of frame
+ * @param frame searched frame
+ * @param name id of name of variable
+ * @return variable or NULL if it is not defined
+*/
+static interpreter_value_t *frame_find(interpreter_frame_t *frame, unsigned name){
+    unsigned mask = frame->capacity - 1;
+    for(unsigned slot = frame_hash(name, frame->capacity); ; slot = (slot + 1) & mask){
+        if(frame->names[slot] == name){
+            return &frame->values[slot];
+        }
+        if(frame->names[slot] == INTERPRETER_NO_INDEX){
+            return NULL;
+        }
+    }
+}
+
+/**
+ * Doubles capacity of frame
+ * @param frame resized frame
+ * @return false on allocation error
+*/
+static bool frame_grow(interpreter_frame_t *frame){
+    unsigned capacity = frame->capacity * 2;
+    unsigned *names = malloc(capacity * sizeof(unsigned));
+    interpreter_value_t *values = malloc(capacity * sizeof(interpreter_value_t));
+    if(names == NULL || values == NULL){
+        free(names);
+        free(values);
+        return false;
+    }
+
+    for(unsigned i = 0; i < capacity; i++){
+        names[i] = INTERPRETER_NO_INDEX;
+    }
+
+    for(unsigned i = 0; i < frame->capacity; i++){
+        if(frame->names[i] == INTERPRETER_NO_INDEX){
+            continue;
+        }
+        unsigned slot = frame_hash(frame->names[i], capacity);
+        while(names[slot] != INTERPRETER_NO_INDEX){
+            slot = (slot + 1) & (capacity - 1);
+        }
+        names[slot] = frame->names[i];
+        values[slot] = frame->values[i];
+    }
+
+    free(frame->names);
+    free(frame->values);
+    frame->names = names;
+    frame->values = values;
+    frame->capacity = capacity;
+    return true;
+}
+
+/**
+ * Defines uninitialized variable in frame
+ * @param frame target frame
+ * @param name id of name of variable
+ * @return 0, ERR_RUN_SEMANTIC if variable exists or ERR_INTERNAL
+*/
+static int frame_define(interpreter_frame_t *frame, unsigned name){
+    // at least half of slots stays free
+    if((frame->count + 1) * 2 > frame->capacity && !frame_grow(frame)){
+        return ERR_INTERNAL;
+    }
+
+    unsigned slot = frame_hash(name, frame->capacity);
+    while(frame->names[slot] != INTERPRETER_NO_INDEX){
+        if(frame->names[slot] == name){
+            return ERR_RUN_SEMANTIC;
+        }
+        slot = (slot + 1) & (frame->capacity - 1);
+    }
+
+    frame->names[slot] = name;
+    frame->values[slot].type = VALUE_UNINITIALIZED;
+    frame->count++;
+    return 0;
+}
+
+/* ------------------------------------------------------------------ state */
+
+/**
+ * Gets variable of operand
+ * @param state state of interpreter (error is set on failure)
+ * @param operand variable or constant operand
+ * @return variable (possibly uninitialized), constant or NULL on error
+*/
+static interpreter_value_t *interpreter_variable(interpreter_t *state, interpreter_operand_t *operand){
+    interpreter_value_t *value = NULL;
+
+    switch(operand->kind){
+        case OPERAND_GLOBAL:
+            value = &state->globals[operand->index];
+            if(value->type == VALUE_UNDECLARED){
+                state->error = ERR_RUN_UNDEFINED_VARIABLE;
+                return NULL;
+            }
+            return value;
+        case OPERAND_LOCAL:
+            if(state->frame_count == 0){
+                state->error = ERR_RUN_FRAME;
+                return NULL;
+            }
+            value = frame_find(state->frames[state->frame_count - 1], operand->index);
+            break;
+        case OPERAND_TEMPORARY:
+            if(state->temporary == NULL){
+                state->error = ERR_RUN_FRAME;
+                return NULL;
+            }
+            value = frame_find(state->temporary, operand->index);
+            break;
+        default:
+            return &operand->constant;
+    }
+
+    if(value == NULL){
+        state->error = ERR_RUN_UNDEFINED_VARIABLE;
+    }
+    return value;
+}
+
+/**
+ * Gets initialized value of operand
+ * @param state state of interpreter (error is set on failure)
+ * @param operand variable or constant operand
+ * @return value or NULL on error
+*/
+static interpreter_value_t *interpreter_symbol(interpreter_t *state, interpreter_operand_t *operand){
+    interpreter_value_t *value = interpreter_variable(state, operand);
+    if(value != NULL && value->type == VALUE_UNINITIALIZED){
+        state->error = ERR_RUN_MISSING_VALUE;
+        return NULL;
+    }
+    return value;
+}
+
+/**
+ * Pushes value to data stack (reference is taken over by stack)
+ * @param state state of interpreter
+ * @param value pushed value
+ * @return 0 or ERR_INTERNAL
+*/
+static int interpreter_push(interpreter_t *state, const interpreter_value_t *value){
+    if(state->stack_count == state->stack_capacity){
+        unsigned capacity = state->stack_capacity == 0 ? STACK_INITIAL_CAPACITY : state->stack_capacity * 2;
+        interpreter_value_t *stack = realloc(state->stack, capacity * sizeof(interpreter_value_t));
+        if(stack == NULL){
+            return ERR_INTERNAL;
+        }
+        state->stack = stack;
+        state->stack_capacity = capacity;
+    }
+
+    state->stack[state->stack_count++] = *value;
+    return 0;
+}
+
+/**
+ * Pops values from data stack (references are taken over by caller)
+ * @param state state of interpreter
+ * @param values popped values in order of pushing
+ * @param count count of popped values
+ * @return 0 or ERR_RUN_MISSING_VALUE
+*/
+static int interpreter_pop(interpreter_t *state, interpreter_value_t *values, unsigned count){
+    if(state->stack_count < count){
+        return ERR_RUN_MISSING_VALUE;
+    }
+
+    state->stack_count -= count;
+    memcpy(values, &state->stack[state->stack_count], count * sizeof(interpreter_value_t));
+    return 0;
+}
+
+/**
+ * Gets message describing error code
+ * @param error error code of interpreter
+*/
+static const char *interpreter_error_message(int error){
+    switch(error){
+        case ERR_RUN_SEMANTIC:
+            return "undefined label or redefinition of variable";
+        case ERR_RUN_OPERAND_TYPE:
+            return "wrong types of operands";
+        case ERR_RUN_UNDEFINED_VARIABLE:
+            return "access to undefined variable";
+        case ERR_RUN_FRAME:
+            return "frame does not exist";
+        case ERR_RUN_MISSING_VALUE:
+            return "missing value";
+        case ERR_RUN_OPERAND_VALUE:
+            return "wrong value of operand";
+        case ERR_RUN_STRING:
+            return "wrong work with string";
+        default:
+            return "internal error";
+    }
+}
+
+/**
+ * Frees all frames, stacks and variables of state
+ * @param state disposed state
+*/
+static void interpreter_dispose(interpreter_t *state, unsigned global_count){
+    for(unsigned i = 0; i < global_count; i++){
+        value_release(&state->globals[i]);
+    }
+    for(unsigned i = 0; i < state->stack_count; i++){
+        value_release(&state->stack[i]);
+    }
+    for(unsigned i = 0; i < state->frame_count; i++){
+        frame_dispose(state, state->frames[i]);
+    }
+    if(state->temporary != NULL){
+        frame_dispose(state, state->temporary);
+    }
+    while(state->unused != NULL){
+        interpreter_frame_t *next = state->unused->next;
+        frame_free(state->unused);
+        state->unused = next;
+    }
+
+    free(state->globals);
+    free(state->stack);
+    free(state->calls);
+    free(state->call_starts);
+    free(state->call_active);
+    free(state->frames);
+}
+
+/* ---------------------------------------------------------------- execute */
+
+#define FAIL(code) do { state.error = (code); goto failure; } while(0)
+#define CHECK(call) do { if((state.error = (call)) != 0) goto failure; } while(0)
+#define VARIABLE(value, index) do { if((value = interpreter_variable(&state, &instruction->operands[index])) == NULL) goto failure; } while(0)
+#define SYMBOL(value, index) do { if((value = interpreter_symbol(&state, &instruction->operands[index])) == NULL) goto failure; } while(0)
+#define JUMP_TARGET() do { if(instruction->operands[0].index == INTERPRETER_NO_INDEX) FAIL(ERR_RUN_SEMANTIC); } while(0)
+#define FUEL() do { if(state.fuel-- == 0) FAIL(INTERPRETER_NO_FUEL); } while(0)
+
+#define PROFILE_COUNT() do { profile->instructions[instruction - code]++; profile->dispatches++; } while(0)
+
+#ifdef INTERPRETER_THREADED
+#define DISPATCH() do { instruction = &code[pc++]; PEDANTIC_OFF goto *instruction->handler; PEDANTIC_ON } while(0)
+#define HANDLER(opcode) case opcode: handler_##opcode
+#else
+#define DISPATCH() goto dispatch
+#define HANDLER(opcode) case opcode
+#endif
+
+/**
+ * Executes decoded program
+ * @param program decoded program
+ * @param input stream read by READ (NULL for evaluation)
+ * @param output stream written by WRITE (NULL for evaluation)
+ * @param debug DPRINT and BREAK print to stderr (ignored otherwise)
+ * @param profile counts of executed instructions (NULL runs without counting)
+ * @param fuel remaining count of executed jumps and calls (decreased by run)
+ * @param literal constant of value on top of data stack at the end of program (NULL prints errors to stderr)
+ * @return operand of EXIT, 0 at the end of program, INTERPRETER_NO_FUEL or error code of interpreter
+*/
+static int interpreter_execute(interpreter_program_t *program, FILE *input, FILE *output, bool debug,
+                               interpreter_profile_t *profile, unsigned long long *fuel, char **literal){
+#ifdef INTERPRETER_THREADED
+    PEDANTIC_OFF
+    static const void *handlers[OP_UNKNOWN] = {
+        [OP_MOVE] = &&handler_OP_MOVE, [OP_CREATEFRAME] = &&handler_OP_CREATEFRAME,
+        [OP_PUSHFRAME] = &&handler_OP_PUSHFRAME, [OP_POPFRAME] = &&handler_OP_POPFRAME,
+        [OP_DEFVAR] = &&handler_OP_DEFVAR, [OP_CALL] = &&handler_OP_CALL, [OP_RETURN] = &&handler_OP_RETURN,
+        [OP_PUSHS] = &&handler_OP_PUSHS, [OP_POPS] = &&handler_OP_POPS, [OP_CLEARS] = &&handler_OP_CLEARS,
+        [OP_ADD] = &&handler_OP_ADD, [OP_SUB] = &&handler_OP_SUB, [OP_MUL] = &&handler_OP_MUL,
+        [OP_DIV] = &&handler_OP_DIV, [OP_IDIV] = &&handler_OP_IDIV,
+        [OP_ADDS] = &&handler_OP_ADDS, [OP_SUBS] = &&handler_OP_SUBS, [OP_MULS] = &&handler_OP_MULS,
+        [OP_DIVS] = &&handler_OP_DIVS, [OP_IDIVS] = &&handler_OP_IDIVS,
+        [OP_LT] = &&handler_OP_LT, [OP_GT] = &&handler_OP_GT, [OP_EQ] = &&handler_OP_EQ,
+        [OP_LTS] = &&handler_OP_LTS, [OP_GTS] = &&handler_OP_GTS, [OP_EQS] = &&handler_OP_EQS,
+        [OP_AND] = &&handler_OP_AND, [OP_OR] = &&handler_OP_OR, [OP_NOT] = &&handler_OP_NOT,
+        [OP_ANDS] = &&handler_OP_ANDS, [OP_ORS] = &&handler_OP_ORS, [OP_NOTS] = &&handler_OP_NOTS,
+        [OP_INT2FLOAT] = &&handler_OP_INT2FLOAT, [OP_FLOAT2INT] = &&handler_OP_FLOAT2INT,
+        [OP_INT2CHAR] = &&handler_OP_INT2CHAR, [OP_STRI2INT] = &&handler_OP_STRI2INT,
+        [OP_INT2FLOATS] = &&handler_OP_INT2FLOATS, [OP_FLOAT2INTS] = &&handler_OP_FLOAT2INTS,
+        [OP_INT2CHARS] = &&handler_OP_INT2CHARS, [OP_STRI2INTS] = &&handler_OP_STRI2INTS,
+        [OP_READ] = &&handler_OP_READ, [OP_WRITE] = &&handler_OP_WRITE, [OP_CONCAT] = &&handler_OP_CONCAT,
+        [OP_STRLEN] = &&handler_OP_STRLEN, [OP_GETCHAR] = &&handler_OP_GETCHAR, [OP_SETCHAR] = &&handler_OP_SETCHAR,
+        [OP_TYPE] = &&handler_OP_TYPE, [OP_LABEL] = &&handler_OP_LABEL, [OP_JUMP] = &&handler_OP_JUMP,
+        [OP_JUMPIFEQ] = &&handler_OP_JUMPIFEQ, [OP_JUMPIFNEQ] = &&handler_OP_JUMPIFNEQ,
+        [OP_JUMPIFEQS] = &&handler_OP_JUMPIFEQS, [OP_JUMPIFNEQS] = &&handler_OP_JUMPIFNEQS,
+        [OP_EXIT] = &&handler_OP_EXIT, [OP_BREAK] = &&handler_OP_BREAK, [OP_DPRINT] = &&handler_OP_DPRINT,
+    };
+
+    // profiled instructions are counted before jump to their code, so run without profile counts nothing
+    for(unsigned i = 0; i < program->instruction_count; i++){
+        program->instructions[i].handler = profile != NULL ? &&profile_dispatch : handlers[program->instructions[i].opcode];
+    }
+    PEDANTIC_ON
+#endif
+
+    interpreter_t state;
+    memset(&state, 0, sizeof(interpreter_t));
+    state.fuel = *fuel;
+    state.string_limit = literal != NULL ? INTERPRETER_EVALUATION_MAX_STRING : SIZE_MAX;
+    state.globals = calloc(program->globals.count + 1, sizeof(interpreter_value_t));
+    if(profile != NULL){
+        state.call_active = calloc(program->instruction_count, sizeof(unsigned));
+    }
+    if(state.globals == NULL || (profile != NULL && state.call_active == NULL)){
+        free(state.globals);
+        free(state.call_active);
+        return ERR_INTERNAL;
+    }
+
+    interpreter_instruction_t *code = program->instructions;
+    interpreter_instruction_t *instruction = code;
+    unsigned pc = 0;
+    int result = 0;
+    interpreter_value_t *target = NULL;
+    interpreter_value_t *first = NULL;
+    interpreter_value_t *second = NULL;
+    interpreter_value_t value;
+    interpreter_value_t popped[2];
+
+#ifdef INTERPRETER_THREADED
+    DISPATCH();
+
+profile_dispatch:
+    PROFILE_COUNT();
+    PEDANTIC_OFF
+    goto *handlers[instruction->opcode];
+    PEDANTIC_ON
+#else
+dispatch:
+    instruction = &code[pc++];
+    if(profile != NULL){
+        PROFILE_COUNT();
+    }
+#endif
+    switch(instruction->opcode){
+        HANDLER(OP_MOVE):
+            VARIABLE(target, 0);
+            SYMBOL(first, 1);
+            value_copy(target, first);
+            DISPATCH();
+
+        HANDLER(OP_CREATEFRAME):
+            if(state.temporary != NULL){
+                frame_dispose(&state, state.temporary);
+            }
+            if((state.temporary = frame_create(&state)) == NULL){
+                FAIL(ERR_INTERNAL);
+            }
+            DISPATCH();
+
+        HANDLER(OP_PUSHFRAME):
+            if(state.temporary == NULL){
+                FAIL(ERR_RUN_FRAME);
+            }
+            if(state.frame_count == state.frame_capacity){
+                unsigned capacity = state.frame_capacity == 0 ? STACK_INITIAL_CAPACITY : state.frame_capacity * 2;
+                interpreter_frame_t **frames = realloc(state.frames, capacity * sizeof(interpreter_frame_t *));
+                if(frames == NULL){
+                    FAIL(ERR_INTERNAL);
+                }
+                state.frames = frames;
+                state.frame_capacity = capacity;
+            }
+            state.frames[state.frame_count++] = state.temporary;
+            state.temporary = NULL;
+            DISPATCH();
+
+        HANDLER(OP_POPFRAME):
+            if(state.frame_count == 0){
+                FAIL(ERR_RUN_FRAME);
+            }
+            if(state.temporary != NULL){
+                frame_dispose(&state, state.temporary);
+            }
+            state.temporary = state.frames[--state.frame_count];
+            DISPATCH();
+
+        HANDLER(OP_DEFVAR):
+            switch(instruction->operands[0].kind){
+                case OPERAND_GLOBAL:
+                    target = &state.globals[instruction->operands[0].index];
+                    if(target->type != VALUE_UNDECLARED){
+                        FAIL(ERR_RUN_SEMANTIC);
+                    }
+                    target->type = VALUE_UNINITIALIZED;
+                    break;
+                case OPERAND_LOCAL:
+                    if(state.frame_count == 0){
+                        FAIL(ERR_RUN_FRAME);
+                    }
+                    CHECK(frame_define(state.frames[state.frame_count - 1], instruction->operands[0].index));
+                    break;
+                default:
+                    if(state.temporary == NULL){
+                        FAIL(ERR_RUN_FRAME);
+                    }
+                    CHECK(frame_define(state.temporary, instruction->operands[0].index));
+                    break;
+            }
+            DISPATCH();
+
+        HANDLER(OP_CALL):
+            JUMP_TARGET();
+            FUEL();
+            if(state.call_count == state.call_capacity){
+                unsigned capacity = state.call_capacity == 0 ? STACK_INITIAL_CAPACITY : state.call_capacity * 2;
+                unsigned *calls = realloc(state.calls, capacity * sizeof(unsigned));
+                if(calls != NULL){
+                    state.calls = calls;
+                }
+                unsigned long long *starts = profile == NULL ? NULL : realloc(state.call_starts, capacity * sizeof(unsigned long long));
+                if(starts != NULL){
+                    state.call_starts = starts;
+                }
+                if(calls == NULL || (profile != NULL && starts == NULL)){
+                    FAIL(ERR_INTERNAL);
+                }
+                state.call_capacity = capacity;
+            }
+            if(profile != NULL){
+                state.call_starts[state.call_count] = profile->dispatches;
+                state.call_active[pc - 1]++;
+            }
+            state.calls[state.call_count++] = pc;
+            pc = instruction->operands[0].index + 1;
+            DISPATCH();
+
+        HANDLER(OP_RETURN):
+            if(state.call_count == 0){
+                FAIL(ERR_RUN_MISSING_VALUE);
+            }
+            pc = state.calls[--state.call_count];
+            if(profile != NULL && --state.call_active[pc - 1] == 0){
+                // return address follows CALL instruction, recursive calls are included in the outermost one
+                profile->calls[pc - 1] += profile->dispatches - state.call_starts[state.call_count];
+            }
+            DISPATCH();
+
+        HANDLER(OP_PUSHS):
+            SYMBOL(first, 0);
+            if(first->type == VALUE_STRING){
+                first->data.string_val->references++;
+            }
+            CHECK(interpreter_push(&state, first));
+            DISPATCH();
+
+        HANDLER(OP_POPS):
+            VARIABLE(target, 0);
+            CHECK(interpreter_pop(&state, &value, 1));
+            value_move(target, &value);
+            DISPATCH();
+
+        HANDLER(OP_CLEARS):
+            while(state.stack_count > 0){
+                value_release(&state.stack[--state.stack_count]);
+            }
+            DISPATCH();
+
+        HANDLER(OP_ADD):
+        HANDLER(OP_SUB):
+        HANDLER(OP_MUL):
+        HANDLER(OP_DIV):
+        HANDLER(OP_IDIV):
+            VARIABLE(target, 0);
+            SYMBOL(first, 1);
+            SYMBOL(second, 2);
+            CHECK(value_arithmetic(instruction->opcode, first, second, &value));
+            value_move(target, &value);
+            DISPATCH();
+
+        HANDLER(OP_ADDS):
+        HANDLER(OP_SUBS):
+        HANDLER(OP_MULS):
+        HANDLER(OP_DIVS):
+        HANDLER(OP_IDIVS):
+            CHECK(interpreter_pop(&state, popped, 2));
+            state.error = value_arithmetic(instruction->opcode - OP_ADDS + OP_ADD, &popped[0], &popped[1], &value);
+            value_release(&popped[0]);
+            value_release(&popped[1]);
+            if(state.error != 0){
+                goto failure;
+            }
+            CHECK(interpreter_push(&state, &value));
+            DISPATCH();
+
+        HANDLER(OP_LT):
+        HANDLER(OP_GT):
+        HANDLER(OP_EQ):
+            VARIABLE(target, 0);
+            SYMBOL(first, 1);
+            SYMBOL(second, 2);
+            CHECK(value_compare(instruction->opcode, first, second, &value));
+            value_move(target, &value);
+            DISPATCH();
+
+        HANDLER(OP_LTS):
+        HANDLER(OP_GTS):
+        HANDLER(OP_EQS):
+            CHECK(interpreter_pop(&state, popped, 2));
+            state.error = value_compare(instruction->opcode - OP_LTS + OP_LT, &popped[0], &popped[1], &value);
+            value_release(&popped[0]);
+            value_release(&popped[1]);
+            if(state.error != 0){
+                goto failure;
+            }
+            CHECK(interpreter_push(&state, &value));
+            DISPATCH();
+
+        HANDLER(OP_AND):
+        HANDLER(OP_OR):
+        HANDLER(OP_NOT):
+            VARIABLE(target, 0);
+            SYMBOL(first, 1);
+            second = first;
+            if(instruction->opcode != OP_NOT){
+                SYMBOL(second, 2);
+            }
+            CHECK(value_logic(instruction->opcode, first, second, &value));
+            value_move(target, &value);
+            DISPATCH();
+
+        HANDLER(OP_ANDS):
+        HANDLER(OP_ORS):
+            CHECK(interpreter_pop(&state, popped, 2));
+            state.error = value_logic(instruction->opcode - OP_ANDS + OP_AND, &popped[0], &popped[1], &value);
+            value_release(&popped[0]);
+            value_release(&popped[1]);
+            if(state.error != 0){
+                goto failure;
+            }
+            CHECK(interpreter_push(&state, &value));
+            DISPATCH();
+
+        HANDLER(OP_NOTS):
+            CHECK(interpreter_pop(&state, popped, 1));
+            state.error = value_logic(OP_NOT, &popped[0], &popped[0], &value);
+            value_release(&popped[0]);
+            if(state.error != 0){
+                goto failure;
+            }
+            CHECK(interpreter_push(&state, &value));
+            DISPATCH();
+
+        HANDLER(OP_INT2FLOAT):
+        HANDLER(OP_FLOAT2INT):
+        HANDLER(OP_INT2CHAR):
+        HANDLER(OP_STRI2INT):
+            VARIABLE(target, 0);
+            SYMBOL(first, 1);
+            second = first;
+            if(instruction->opcode == OP_STRI2INT){
+                SYMBOL(second, 2);
+            }
+            CHECK(value_convert(instruction->opcode, first, second, &value));
+            value_move(target, &value);
+            DISPATCH();
+
+        HANDLER(OP_INT2FLOATS):
+        HANDLER(OP_FLOAT2INTS):
+        HANDLER(OP_INT2CHARS):
+            CHECK(interpreter_pop(&state, popped, 1));
+            state.error = value_convert(instruction->opcode - OP_INT2FLOATS + OP_INT2FLOAT, &popped[0], &popped[0], &value);
+            value_release(&popped[0]);
+            if(state.error != 0){
+                goto failure;
+            }
+            CHECK(interpreter_push(&state, &value));
+            DISPATCH();
+
+        HANDLER(OP_STRI2INTS):
+            CHECK(interpreter_pop(&state, popped, 2));
+            state.error = value_convert(OP_STRI2INT, &popped[0], &popped[1], &value);
+            value_release(&popped[0]);
+            value_release(&popped[1]);
+            if(state.error != 0){
+                goto failure;
+            }
+            CHECK(interpreter_push(&state, &value));
+            DISPATCH();
+
+        HANDLER(OP_READ):
+            VARIABLE(target, 0);
+            if(input == NULL){
+                FAIL(ERR_INTERNAL);
+            }
+            fflush(output);
+            CHECK(value_read(input, instruction->operands[1].constant.type, &value));
+            value_move(target, &value);
+            DISPATCH();
+
+        HANDLER(OP_WRITE):
+            SYMBOL(first, 0);
+            if(output == NULL){
+                FAIL(ERR_INTERNAL);
+            }
+            value_write(first, output);
+            DISPATCH();
+
+        HANDLER(OP_CONCAT):
+            VARIABLE(target, 0);
+            SYMBOL(first, 1);
+            SYMBOL(second, 2);
+            if(first->type != VALUE_STRING || second->type != VALUE_STRING){
+                FAIL(ERR_RUN_OPERAND_TYPE);
+            }
+            if(first->data.string_val->length + second->data.string_val->length > state.string_limit){
+                FAIL(INTERPRETER_NO_FUEL);
+            }
+            if(target == first && first->data.string_val->references == 1 && first->data.string_val != second->data.string_val){
+                // only owner of string appends in place
+                if(!string_append(first->data.string_val, second->data.string_val->chars, second->data.string_val->length)){
+                    FAIL(ERR_INTERNAL);
+                }
+                DISPATCH();
+            }
+            value.type = VALUE_STRING;
+            if((value.data.string_val = string_create(first->data.string_val->chars, first->data.string_val->length)) == NULL){
+                FAIL(ERR_INTERNAL);
+            }
+            if(!string_append(value.data.string_val, second->data.string_val->chars, second->data.string_val->length)){
+                string_release(value.data.string_val);
+                FAIL(ERR_INTERNAL);
+            }
+            value_move(target, &value);
+            DISPATCH();
+
+        HANDLER(OP_STRLEN):
+            VARIABLE(target, 0);
+            SYMBOL(first, 1);
+            if(first->type != VALUE_STRING){
+                FAIL(ERR_RUN_OPERAND_TYPE);
+            }
+            value.type = VALUE_INT;
+            value.data.int_val = (long long)first->data.string_val->length;
+            value_move(target, &value);
+            DISPATCH();
+
+        HANDLER(OP_GETCHAR):
+            VARIABLE(target, 0);
+            SYMBOL(first, 1);
+            SYMBOL(second, 2);
+            if(first->type != VALUE_STRING || second->type != VALUE_INT){
+                FAIL(ERR_RUN_OPERAND_TYPE);
+            }
+            if(second->data.int_val < 0 || (unsigned long long)second->data.int_val >= first->data.string_val->length){
+                FAIL(ERR_RUN_STRING);
+            }
+            CHECK(value_string(&value, &first->data.string_val->chars[second->data.int_val], 1));
+            value_move(target, &value);
+            DISPATCH();
+
+        HANDLER(OP_SETCHAR):
+            SYMBOL(target, 0);
+            SYMBOL(first, 1);
+            SYMBOL(second, 2);
+            if(target->type != VALUE_STRING || first->type != VALUE_INT || second->type != VALUE_STRING){
+                FAIL(ERR_RUN_OPERAND_TYPE);
+            }
+            if(first->data.int_val < 0 || (unsigned long long)first->data.int_val >= target->data.string_val->length ||
+               second->data.string_val->length == 0){
+                FAIL(ERR_RUN_STRING);
+            }
+            if(target->data.string_val->references > 1){
+                // shared string is copied before change
+                CHECK(value_string(&value, target->data.string_val->chars, target->data.string_val->length));
+                value_move(target, &value);
+            }
+            target->data.string_val->chars[first->data.int_val] = second->data.string_val->chars[0];
+            DISPATCH();
+
+        HANDLER(OP_TYPE): {
+            static const char *type_names[] = {
+                [VALUE_UNDECLARED] = "", [VALUE_UNINITIALIZED] = "", [VALUE_NIL] = "nil", [VALUE_INT] = "int",
+                [VALUE_FLOAT] = "float", [VALUE_BOOL] = "bool", [VALUE_STRING] = "string",
+            };
+            VARIABLE(target, 0);
+            VARIABLE(first, 1);
+            const char *name = type_names[first->type];
+            CHECK(value_string(&value, name, strlen(name)));
+            value_move(target, &value);
+            DISPATCH();
+        }
+
+        HANDLER(OP_LABEL):
+            DISPATCH();
+
+        HANDLER(OP_JUMP):
+            JUMP_TARGET();
+            FUEL();
+            pc = instruction->operands[0].index + 1;
+            DISPATCH();
+
+        HANDLER(OP_JUMPIFEQ):
+        HANDLER(OP_JUMPIFNEQ):
+            JUMP_TARGET();
+            FUEL();
+            SYMBOL(first, 1);
+            SYMBOL(second, 2);
+            CHECK(value_compare(OP_EQ, first, second, &value));
+            if(value.data.bool_val == (instruction->opcode == OP_JUMPIFEQ)){
+                pc = instruction->operands[0].index + 1;
+            }
+            DISPATCH();
+
+        HANDLER(OP_JUMPIFEQS):
+        HANDLER(OP_JUMPIFNEQS):
+            JUMP_TARGET();
+            FUEL();
+            CHECK(interpreter_pop(&state, popped, 2));
+            state.error = value_compare(OP_EQ, &popped[0], &popped[1], &value);
+            value_release(&popped[0]);
+            value_release(&popped[1]);
+            if(state.error != 0){
+                goto failure;
+            }
+            if(value.data.bool_val == (instruction->opcode == OP_JUMPIFEQS)){
+                pc = instruction->operands[0].index + 1;
+            }
+            DISPATCH();
+
+        HANDLER(OP_EXIT):
+            SYMBOL(first, 0);
+            if(first->type != VALUE_INT){
+                FAIL(ERR_RUN_OPERAND_TYPE);
+            }
+            if(first->data.int_val < 0 || first->data.int_val > 49){
+                FAIL(ERR_RUN_OPERAND_VALUE);
+            }
+            result = (int)first->data.int_val;
+            goto finish;
+
+        HANDLER(OP_BREAK):
+            if(debug){
+                fprintf(stderr, "Line: %u\nLocal frames: %u\nCalls: %u\nData stack: %u\n",
+                        instruction->line, state.frame_count, state.call_count, state.stack_count);
+            }
+            DISPATCH();
+
+        HANDLER(OP_DPRINT):
+            SYMBOL(first, 0);
+            if(debug){
+                value_write(first, stderr);
+            }
+            DISPATCH();
+
+        default:
+            FAIL(ERR_INTERNAL);
+    }
+
+failure:
+    result = state.error;
+    if(literal == NULL){
+        print_error(result, "line %u: %s\n", instruction->line, interpreter_error_message(result));
+    }
+
+finish:
+    if(output != NULL){
+        fflush(output);
+    }
+    if(literal != NULL && result == 0 && state.stack_count > 0 &&
+       (*literal = value_literal(&state.stack[state.stack_count - 1])) == NULL){
+        result = ERR_INTERNAL;
+    }
+    *fuel = state.fuel;
+    interpreter_dispose(&state, program->globals.count);
+    return result;
+}
+
+int interpreter_run(interpreter_program_t *program, FILE *input, FILE *output, bool debug, interpreter_profile_t *profile){
+    unsigned long long fuel = ULLONG_MAX;
+    return interpreter_execute(program, input, output, debug, profile, &fuel, NULL);
+}
+
+int interpreter_evaluate(interpreter_program_t *program, unsigned long long *fuel, char **literal){
+    *literal = NULL;
+    return interpreter_execute(program, NULL, NULL, false, NULL, fuel, literal);
+}
+
+/* ------------------------------------------------------------------- load */
+
+/**
+ * Gets slot of name in table of given capacity
+ * @param name name of variable or label
+ * @param capacity capacity of table (power of 2)
+*/
+static unsigned names_hash(const char *name, unsigned capacity){
+    unsigned hash = 5381;
+    for(const char *c = name; *c != '\0'; c++){
+        hash = hash * 33 + (unsigned char)*c;
+    }
+    // short names (compact output) have close hashes, high bits are mixed into low ones
+    hash ^= hash >> 16;
+    hash *= 0x45d9f3bu;
+    hash ^= hash >> 16;
+    return hash & (capacity - 1);
+}
+
+/**
+ * Frees names of table
+ * @param names disposed table
+*/
+static void names_dispose(interpreter_names_t *names){
+    for(unsigned i = 0; i < names->count; i++){
+        free(names->names[i]);
+    }
+    free(names->names);
+    free(names->slots);
+    memset(names, 0, sizeof(interpreter_names_t));
+}
+
+/**
+ * Gets id of name (new name gets next free id)
+ * @param names table of names
+ * @param name searched name
+ * @return id or INTERPRETER_NO_INDEX on allocation error
+*/
+static unsigned names_add(interpreter_names_t *names, const char *name){
+    if((names->count + 1) * 2 > names->capacity){
+        unsigned capacity = names->capacity == 0 ? NAMES_INITIAL_CAPACITY : names->capacity * 2;
+        unsigned *slots = malloc(capacity * sizeof(unsigned));
+        char **resized = realloc(names->names, capacity * sizeof(char *));
+        if(slots == NULL || resized == NULL){
+            free(slots);
+            if(resized != NULL){
+                names->names = resized;
+            }
+            return INTERPRETER_NO_INDEX;
+        }
+
+        for(unsigned i = 0; i < capacity; i++){
+            slots[i] = INTERPRETER_NO_INDEX;
+        }
+        for(unsigned id = 0; id < names->count; id++){
+            unsigned slot = names_hash(resized[id], capacity);
+            while(slots[slot] != INTERPRETER_NO_INDEX){
+                slot = (slot + 1) & (capacity - 1);
+            }
+            slots[slot] = id;
+        }
+
+        free(names->slots);
+        names->slots = slots;
+        names->names = resized;
+        names->capacity = capacity;
+    }
+
+    unsigned slot = names_hash(name, names->capacity);
+    while(names->slots[slot] != INTERPRETER_NO_INDEX){
+        if(strcmp(names->names[names->slots[slot]], name) == 0){
+            return names->slots[slot];
+        }
+        slot = (slot + 1) & (names->capacity - 1);
+    }
+
+    char *copy = malloc(strlen(name) + 1);
+    if(copy == NULL){
+        return INTERPRETER_NO_INDEX;
+    }
+    strcpy(copy, name);
+
+    names->names[names->count] = copy;
+    names->slots[slot] = names->count;
+    return names->count++;
+}
+
+/**
+ * Decodes variable operand
+ * @param loader state of decoding
+ * @param operand decoded operand
+ * @param text text of operand (GF@x, LF@x or TF@x)
+ * @return 0 or ERR_INTERNAL
+*/
+static int load_variable(loader_t *loader, interpreter_operand_t *operand, const char *text){
+    if(operand_in_frame(text, "GF")){
+        operand->kind = OPERAND_GLOBAL;
+        operand->index = names_add(&loader->program->globals, text + 3);
+    } else {
+        operand->kind = operand_in_frame(text, "LF") ? OPERAND_LOCAL : OPERAND_TEMPORARY;
+        operand->index = names_add(&loader->program->variables, text + 3);
+    }
+
+    return operand->index == INTERPRETER_NO_INDEX ? ERR_INTERNAL : 0;
+}
+
+/**
+ * Decodes constant operand (escape sequences of strings are replaced by chars)
+ * @param operand decoded operand
+ * @param text text of operand (type@value)
+ * @return 0, ERR_RUN_SOURCE or ERR_INTERNAL
+*/
+static int load_constant(interpreter_operand_t *operand, const char *text){
+    const char *value = strchr(text, '@');
+    if(value == NULL){
+        return ERR_RUN_SOURCE;
+    }
+    size_t type_length = value - text;
+    value++;
+
+    operand->kind = OPERAND_CONSTANT;
+    interpreter_value_t *constant = &operand->constant;
+    char *end = NULL;
+
+    if(type_length == 3 && strncmp(text, "int", 3) == 0){
+        constant->type = VALUE_INT;
+        constant->data.int_val = strtoll(value, &end, 10);
+        return *value == '\0' || isspace((unsigned char)*value) || *end != '\0' ? ERR_RUN_SOURCE : 0;
+    }
+
+    if(type_length == 5 && strncmp(text, "float", 5) == 0){
+        constant->type = VALUE_FLOAT;
+        constant->data.float_val = strtod(value, &end);
+        return *value == '\0' || isspace((unsigned char)*value) || *end != '\0' ? ERR_RUN_SOURCE : 0;
+    }
+
+    if(type_length == 4 && strncmp(text, "bool", 4) == 0){
+        constant->type = VALUE_BOOL;
+        constant->data.bool_val = strcmp(value, "true") == 0;
+        return constant->data.bool_val || strcmp(value, "false") == 0 ? 0 : ERR_RUN_SOURCE;
+    }
+
+    if(type_length == 3 && strncmp(text, "nil", 3) == 0){
+        constant->type = VALUE_NIL;
+        return strcmp(value, "nil") == 0 ? 0 : ERR_RUN_SOURCE;
+    }
+
+    if(type_length == 6 && strncmp(text, "string", 6) == 0){
+        // decoded string is never longer than escaped one
+        char *chars = malloc(strlen(value) + 1);
+        if(chars == NULL){
+            return ERR_INTERNAL;
+        }
+
+        size_t length = 0;
+        for(const char *c = value; *c != '\0'; c++){
+            if(*c != '\\'){
+                chars[length++] = *c;
+                continue;
+            }
+
+            if(!isdigit((unsigned char)c[1]) || !isdigit((unsigned char)c[2]) || !isdigit((unsigned char)c[3])){
+                free(chars);
+                return ERR_RUN_SOURCE;
+            }
+            int code = (c[1] - '0') * 100 + (c[2] - '0') * 10 + (c[3] - '0');
+            if(code > UCHAR_MAX){
+                free(chars);
+                return ERR_RUN_SOURCE;
+            }
+            chars[length++] = (char)code;
+            c += 3;
+        }
+
+        int result = value_string(constant, chars, length);
+        free(chars);
+        if(result != 0){
+            constant->type = VALUE_NIL;
+        }
+        return result;
+    }
+
+    return ERR_RUN_SOURCE;
+}
+
+/**
+ * Decodes operand of instruction
+ * @param loader state of decoding
+ * @param operand decoded operand
+ * @param kind kind of operand expected by instruction
+ * @param text text of operand
+ * @return 0 or error code of interpreter
+*/
+static int load_operand(loader_t *loader, interpreter_operand_t *operand, argument_kind_t kind, const char *text){
+    switch(kind){
+        case ARGUMENT_VARIABLE:
+            return operand_is_variable(text) ? load_variable(loader, operand, text) : ERR_RUN_SOURCE;
+        case ARGUMENT_SYMBOL:
+            return operand_is_variable(text) ? load_variable(loader, operand, text) : load_constant(operand, text);
+        case ARGUMENT_LABEL:
+            // index of instruction is known after loading of all labels
+            operand->kind = OPERAND_LABEL;
+            operand->index = names_add(&loader->program->labels, text);
+            return operand->index == INTERPRETER_NO_INDEX ? ERR_INTERNAL : 0;
+        default: {
+            const char *types[] = {"int", "float", "string", "bool"};
+            const value_type_t values[] = {VALUE_INT, VALUE_FLOAT, VALUE_STRING, VALUE_BOOL};
+            operand->kind = OPERAND_TYPE;
+            for(unsigned i = 0; i < 4; i++){
+                if(strcmp(text, types[i]) == 0){
+                    operand->constant.type = values[i];
+                    return 0;
+                }
+            }
+            return ERR_RUN_SOURCE;
+        }
+    }
+}
+
+/**
+ * Appends empty instruction to program
+ * @param program decoded program
+ * @return new instruction or NULL on allocation error
+*/
+static interpreter_instruction_t *load_instruction(interpreter_program_t *program){
+    if(program->instruction_count == program->instruction_capacity){
+        unsigned capacity = program->instruction_capacity == 0 ? STACK_INITIAL_CAPACITY : program->instruction_capacity * 2;
+        interpreter_instruction_t *instructions = realloc(program->instructions, capacity * sizeof(interpreter_instruction_t));
+        if(instructions == NULL){
+            return NULL;
+        }
+        program->instructions = instructions;
+        program->instruction_capacity = capacity;
+    }
+
+    interpreter_instruction_t *instruction = &program->instructions[program->instruction_count++];
+    memset(instruction, 0, sizeof(interpreter_instruction_t));
+    return instruction;
+}
+
+/**
+ * Makes room for positions of labels
+ * @param loader state of decoding
+ * @param count count of ids of labels
+ * @return false on allocation error
+*/
+static bool load_label_capacity(loader_t *loader, unsigned count){
+    if(count <= loader->label_capacity){
+        return true;
+    }
+
+    unsigned capacity = loader->label_capacity == 0 ? NAMES_INITIAL_CAPACITY : loader->label_capacity * 2;
+    while(capacity < count){
+        capacity *= 2;
+    }
+    unsigned *positions = realloc(loader->label_positions, capacity * sizeof(unsigned));
+    if(positions == NULL){
+        return false;
+    }
+    for(unsigned i = loader->label_capacity; i < capacity; i++){
+        positions[i] = INTERPRETER_NO_INDEX;
+    }
+    loader->label_positions = positions;
+    loader->label_capacity = capacity;
+    return true;
+}
+
+/**
+ * Remembers position of label
+ * @param loader state of decoding
+ * @param label id of label
+ * @param position index of LABEL instruction
+ * @return 0, ERR_RUN_SEMANTIC if label is redefined or ERR_INTERNAL
+*/
+static int load_label(loader_t *loader, unsigned label, unsigned position){
+    if(!load_label_capacity(loader, label + 1)){
+        return ERR_INTERNAL;
+    }
+
+    if(loader->label_positions[label] != INTERPRETER_NO_INDEX){
+        return ERR_RUN_SEMANTIC;
+    }
+    loader->label_positions[label] = position;
+    return 0;
+}
+
+/**
+ * Decodes parsed instruction
+ * @param loader state of decoding
+ * @param parsed instruction with operands in text form
+ * @return 0 or error code of interpreter
+*/
+static int load_parsed(loader_t *loader, instruction_t *parsed){
+    int result = 0;
+    if(parsed->opcode == OP_UNKNOWN || parsed->operand_count != instruction_table[parsed->opcode].operand_count){
+        result = ERR_RUN_SOURCE;
+    }
+
+    interpreter_instruction_t *instruction = NULL;
+    if(result == 0 && (instruction = load_instruction(loader->program)) == NULL){
+        result = ERR_INTERNAL;
+    }
+
+    if(result == 0){
+        instruction->opcode = parsed->opcode;
+        instruction->line = loader->line;
+
+        for(unsigned i = 0; i < parsed->operand_count && result == 0; i++){
+            result = load_operand(loader, &instruction->operands[i], argument_kinds[parsed->opcode][i], parsed->operands[i]);
+        }
+    }
+
+    if(result == 0 && parsed->opcode == OP_LABEL){
+        result = load_label(loader, instruction->operands[0].index, loader->program->instruction_count - 1);
+    }
+
+    return result;
+}
+
+/**
+ * Decodes one line of source code
+ * @param loader state of decoding
+ * @param line text of line (changed)
+ * @return 0 or error code of interpreter
+*/
+static int load_line(loader_t *loader, char *line){
+    char *comment = strchr(line, '#');
+    if(comment != NULL){
+        *comment = '\0';
+    }
+
+    size_t length = strlen(line);
+    while(length > 0 && isspace((unsigned char)line[length - 1])){
+        line[--length] = '\0';
+    }
+    while(isspace((unsigned char)*line)){
+        line++;
+    }
+    if(*line == '\0'){
+        return 0;
+    }
+
+    if(!loader->header){
+        // header is case insensitive
+        const char *header = HEADER;
+        for(char *c = line; *c != '\0' || *header != '\0'; c++, header++){
+            if(tolower((unsigned char)*c) != tolower((unsigned char)*header)){
+                return ERR_RUN_SOURCE;
+            }
+        }
+        loader->header = true;
+        return 0;
+    }
+
+    instruction_t *parsed = instruction_parse(line);
+    if(parsed == NULL){
+        return ERR_INTERNAL;
+    }
+
+    int result = load_parsed(loader, parsed);
+    instruction_free(parsed);
+    return result;
+}
+
+void interpreter_program_init(interpreter_program_t *program){
+    memset(program, 0, sizeof(interpreter_program_t));
+}
+
+void interpreter_program_dispose(interpreter_program_t *program){
+    for(unsigned i = 0; i < program->instruction_count; i++){
+        for(unsigned j = 0; j < MAX_OPERANDS; j++){
+            if(program->instructions[i].operands[j].kind == OPERAND_CONSTANT){
+                value_release(&program->instructions[i].operands[j].constant);
+            }
+        }
+    }
+
+    free(program->instructions);
+    free(program->label_positions);
+    free(program->source_lines);
+    names_dispose(&program->globals);
+    names_dispose(&program->variables);
+    names_dispose(&program->labels);
+    interpreter_program_init(program);
+}
+
+/**
+ * Ends decoding of program by implicit EXIT int@0 and resolves labels to indexes of instructions
+ * @param loader state of decoding
+ * @param result result of decoding of instructions
+ * @return 0 or error code of interpreter
+*/
+static int load_end(loader_t *loader, int result){
+    interpreter_program_t *program = loader->program;
+
+    interpreter_instruction_t *end = NULL;
+    if(result == 0 && (end = load_instruction(program)) == NULL){
+        result = ERR_INTERNAL;
+    }
+    // every label gets position (labels without LABEL instruction are unresolved)
+    if(result == 0 && !load_label_capacity(loader, program->labels.count)){
+        result = ERR_INTERNAL;
+    }
+
+    if(result == 0){
+        end->opcode = OP_EXIT;
+        end->line = loader->line;
+        end->operands[0].kind = OPERAND_CONSTANT;
+        end->operands[0].constant.type = VALUE_INT;
+
+        for(unsigned i = 0; i < program->instruction_count; i++){
+            for(unsigned j = 0; j < MAX_OPERANDS; j++){
+                interpreter_operand_t *operand = &program->instructions[i].operands[j];
+                if(operand->kind == OPERAND_LABEL){
+                    operand->index = loader->label_positions[operand->index];
+                }
+            }
+        }
+    } else {
+        print_error(result, "line %u: invalid IFJcode23\n", loader->line);
+    }
+
+    program->label_positions = loader->label_positions;
+    return result;
+}
+
+int interpreter_load(interpreter_program_t *program, FILE *source){
+    // whole source is read at once
+    size_t capacity = 4096;
+    size_t length = 0;
+    char *text = malloc(capacity);
+    if(text == NULL){
+        return ERR_INTERNAL;
+    }
+
+    size_t read = 0;
+    while((read = fread(text + length, 1, capacity - length - 1, source)) > 0){
+        length += read;
+        if(length + 1 == capacity){
+            char *resized = realloc(text, capacity * 2);
+            if(resized == NULL){
+                free(text);
+                return ERR_INTERNAL;
+            }
+            text = resized;
+            capacity *= 2;
+        }
+    }
+    text[length] = '\0';
+
+    loader_t loader = {program, NULL, 0, 0, false};
+    int result = 0;
+
+    for(char *line = text; line != NULL && result == 0; ){
+        char *end = strchr(line, '\n');
+        if(end != NULL){
+            *end = '\0';
+        }
+
+        loader.line++;
+        result = load_line(&loader, line);
+        line = end == NULL ? NULL : end + 1;
+    }
+
+    if(result == 0 && !loader.header){
+        result = ERR_RUN_SOURCE;
+    }
+
+    free(text);
+    return load_end(&loader, result);
+}
+
+int interpreter_load_code(interpreter_program_t *program, code_buffer_t *code){
+    loader_t loader = {program, NULL, 0, 0, true};
+    int result = 0;
+
+    for(instruction_t *i = code->head; i != NULL && result == 0; i = i->next){
+        loader.line++;
+        result = load_parsed(&loader, i);
+    }
+
+    return load_end(&loader, result);
+}
+
+/**
+ * Decodes operand of binary container
+ * @param loader state of decoding
+ * @param binary opened container
+ * @param ids ids of names of container by kinds of operands (created by first use)
+ * @param constants decoded constants of container
+ * @param operand decoded operand
+ * @param kind kind of operand expected by instruction
+ * @param encoded encoded operand
+ * @return 0, ERR_RUN_SOURCE or ERR_INTERNAL
+*/
+static int load_binary_operand(loader_t *loader, code_binary_t *binary, unsigned *ids[], interpreter_value_t *constants,
+                               interpreter_operand_t *operand, argument_kind_t kind, binary_operand_t *encoded){
+    bool variable = encoded->kind == BINARY_GLOBAL || encoded->kind == BINARY_LOCAL || encoded->kind == BINARY_TEMPORARY;
+    if((kind == ARGUMENT_VARIABLE && !variable) || (kind == ARGUMENT_SYMBOL && !variable && encoded->kind != BINARY_CONSTANT) ||
+       (kind == ARGUMENT_LABEL && encoded->kind != BINARY_LABEL) || (kind == ARGUMENT_TYPE && encoded->kind != BINARY_TYPE)){
+        return ERR_RUN_SOURCE;
+    }
+
+    interpreter_names_t *tables[] = {NULL, &loader->program->globals, &loader->program->variables,
+                                     &loader->program->variables, &loader->program->labels, NULL};
+    const operand_kind_t kinds[] = {OPERAND_CONSTANT, OPERAND_GLOBAL, OPERAND_LOCAL, OPERAND_TEMPORARY, OPERAND_LABEL, OPERAND_TYPE};
+    operand->kind = kinds[encoded->kind];
+
+    if(encoded->kind == BINARY_CONSTANT){
+        value_copy(&operand->constant, &constants[encoded->index]);
+        return 0;
+    }
+
+    if(encoded->kind == BINARY_TYPE){
+        const char *types[] = {"int", "float", "string", "bool"};
+        const value_type_t values[] = {VALUE_INT, VALUE_FLOAT, VALUE_STRING, VALUE_BOOL};
+        for(unsigned i = 0; i < 4; i++){
+            if(strcmp(binary->names[encoded->index], types[i]) == 0){
+                operand->constant.type = values[i];
+                return 0;
+            }
+        }
+        return ERR_RUN_SOURCE;
+    }
+
+    // local and temporary variables share ids
+    unsigned *id = &ids[encoded->kind == BINARY_TEMPORARY ? BINARY_LOCAL : encoded->kind][encoded->index];
+    if(*id == INTERPRETER_NO_INDEX){
+        *id = names_add(tables[encoded->kind], binary->names[encoded->index]);
+    }
+    operand->index = *id;
+    return *id == INTERPRETER_NO_INDEX ? ERR_INTERNAL : 0;
+}
+
+int interpreter_load_binary(interpreter_program_t *program, const unsigned char *data, size_t size){
+    code_binary_t binary;
+    if(!code_binary_open(&binary, data, size)){
+        print_error(ERR_RUN_SOURCE, "invalid binary IFJcode23\n");
+        return ERR_RUN_SOURCE;
+    }
+
+    loader_t loader = {program, NULL, 0, 1, true};
+    int result = 0;
+
+    // constants of pool are decoded once and shared by operands
+    interpreter_value_t *constants = calloc(binary.constant_count + 1, sizeof(interpreter_value_t));
+    unsigned *ids[BINARY_LABEL + 1] = {NULL};
+    for(unsigned kind = BINARY_GLOBAL; kind <= BINARY_LABEL; kind++){
+        ids[kind] = malloc((binary.name_count + 1) * sizeof(unsigned));
+        for(unsigned i = 0; ids[kind] != NULL && i < binary.name_count; i++){
+            ids[kind][i] = INTERPRETER_NO_INDEX;
+        }
+        if(ids[kind] == NULL){
+            result = ERR_INTERNAL;
+        }
+    }
+    if(constants == NULL){
+        result = ERR_INTERNAL;
+    }
+
+    for(unsigned i = 0; i < binary.constant_count && result == 0; i++){
+        binary_constant_t *constant = &binary.constants[i];
+        const value_type_t types[] = {VALUE_NIL, VALUE_INT, VALUE_FLOAT, VALUE_BOOL, VALUE_STRING};
+        constants[i].type = types[constant->type];
+        constants[i].data.int_val = constant->int_val;
+        if(constant->type == BINARY_FLOAT){
+            constants[i].data.float_val = constant->float_val;
+        } else if(constant->type == BINARY_BOOL){
+            constants[i].data.bool_val = constant->bool_val;
+        } else if(constant->type == BINARY_STRING && value_string(&constants[i], constant->string_val, constant->length) != 0){
+            constants[i].type = VALUE_NIL;
+            result = ERR_INTERNAL;
+        }
+    }
+
+    size_t position = binary.instructions;
+    for(unsigned i = 0; i < binary.instruction_count && result == 0; i++){
+        binary_instruction_t encoded;
+        if(!code_binary_next(&binary, &position, &encoded)){
+            result = ERR_RUN_SOURCE;
+            break;
+        }
+
+        // line in text form of container (after header)
+        loader.line += encoded.blank_line ? 2 : 1;
+
+        interpreter_instruction_t *instruction = load_instruction(program);
+        if(instruction == NULL){
+            result = ERR_INTERNAL;
+            break;
+        }
+        instruction->opcode = encoded.opcode;
+        instruction->line = loader.line;
+
+        for(unsigned j = 0; j < instruction_table[encoded.opcode].operand_count && result == 0; j++){
+            result = load_binary_operand(&loader, &binary, ids, constants, &instruction->operands[j],
+                                         argument_kinds[encoded.opcode][j], &encoded.operands[j]);
+        }
+
+        if(result == 0 && encoded.opcode == OP_LABEL){
+            result = load_label(&loader, instruction->operands[0].index, program->instruction_count - 1);
+        }
+    }
+
+    for(unsigned i = 0; constants != NULL && i < binary.constant_count; i++){
+        value_release(&constants[i]);
+    }
+    free(constants);
+    for(unsigned kind = BINARY_GLOBAL; kind <= BINARY_LABEL; kind++){
+        free(ids[kind]);
+    }
+    code_binary_close(&binary);
+    return load_end(&loader, result);
+}
+
+int interpreter_load_line_map(interpreter_program_t *program, FILE *map){
+    unsigned *lines = calloc(program->instruction_count + 1, sizeof(unsigned));
+    if(lines == NULL){
+        return ERR_INTERNAL;
+    }
+
+    unsigned index = 0;
+    unsigned line = 0;
+    unsigned column = 0;
+    int matched = 0;
+    while((matched = fscanf(map, "%u %u %u", &index, &line, &column)) == 3){
+        if(index >= program->instruction_count){
+            break;
+        }
+        lines[index] = line;
+    }
+
+    if(matched != EOF){
+        print_error(ERR_RUN_SOURCE, "invalid map of source lines\n");
+        free(lines);
+        return ERR_RUN_SOURCE;
+    }
+
+    free(program->source_lines);
+    program->source_lines = lines;
+    return 0;
+}
+
+/* ---------------------------------------------------------------- profile */
+
+/**
+ * @brief part of program started by label of function, while loop or else branch
+ */
+typedef struct profile_region {
+    const char *label;
+    unsigned function;           // index of region of enclosing function (0 is main program)
+    unsigned long long self;     // dispatches of instructions of region without nested regions
+    unsigned long long total;    // dispatches including nested regions
+} profile_region_t;
+
+/**
+ * Checks if label starts region and finds label, which ends it
+ * @param label name of label
+ * @param end label ending region (buffer for "$$IF_END_n" or "$$FOR_END_n")
+ * @param size size of end buffer
+ * @return true for labels of while loops and else branches
+*/
+static bool profile_region_label(const char *label, char *end, size_t size){
+    const char *id = NULL;
+    const char *prefix = NULL;
+
+    if(strncmp(label, "$$FOR_", strlen("$$FOR_")) == 0 && isdigit((unsigned char)label[strlen("$$FOR_")])){
+        id = label + strlen("$$FOR_");
+        prefix = "$$FOR_END_";
+    } else if(strncmp(label, "$$ELSE_", strlen("$$ELSE_")) == 0){
+        id = label + strlen("$$ELSE_");
+        prefix = "$$IF_END_";
+    } else {
+        return false;
+    }
+
+    // suffix of inlined copy ("$$FOR_3$1") is kept
+    snprintf(end, size, "%s%s", prefix, id);
+    return true;
+}
+
+/**
+ * Checks if label is in code inlined by optimizer ("$$FOR_3$1", clones have suffix "$c" and id)
+ * @param label name of label
+ * @return bool
+*/
+static bool profile_label_inlined(const char *label){
+    for(const char *c = strchr(label + 2, '$'); c != NULL; c = strchr(c + 1, '$')){
+        if(isdigit((unsigned char)c[1])){
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Describes source construct of region
+ * @param regions all regions
+ * @param region described region
+ * @param description output buffer
+ * @param size size of output buffer
+*/
+static void profile_region_source(profile_region_t *regions, profile_region_t *region, char *description, size_t size){
+    const char *function = region->function == 0 ? "main program" : regions[region->function].label + strlen("$$FUNCTION_");
+    const char *label = region->label;
+
+    if(label == NULL){
+        snprintf(description, size, "main program");
+    } else if(strncmp(label, "$$FUNCTION_", strlen("$$FUNCTION_")) == 0){
+        snprintf(description, size, "func %s", label + strlen("$$FUNCTION_"));
+    } else if(strncmp(label, "$$FOR_", strlen("$$FOR_")) == 0){
+        // loops are numbered by parser in order of source
+        const char *id = label + strlen("$$FOR_");
+        snprintf(description, size, "while loop %lu in %s%s%s", strtoul(id, NULL, 10) + 1,
+                 region->function == 0 ? "" : "func ", function, profile_label_inlined(label) ? " (inlined)" : "");
+    } else {
+        snprintf(description, size, "else branch in %s%s%s", region->function == 0 ? "" : "func ", function,
+                 profile_label_inlined(label) ? " (inlined)" : "");
+    }
+}
+
+/**
+ * Compares counts for sorting from the highest (equal counts keep order of their array)
+*/
+static int profile_count_compare(const void *a, const void *b){
+    const unsigned long long *x = *(const unsigned long long * const *)a;
+    const unsigned long long *y = *(const unsigned long long * const *)b;
+    if(*x != *y){
+        return (*x < *y) - (*x > *y);
+    }
+    return (x > y) - (x < y);
+}
+
+/**
+ * Gets percentage of all dispatches
+*/
+static double profile_percent(interpreter_profile_t *profile, unsigned long long count){
+    return profile->dispatches == 0 ? 0.0 : 100.0 * (double)count / (double)profile->dispatches;
+}
+
+/**
+ * Prints dispatches per line of IFJ23 source (instructions without line are not counted)
+ * @param profile counts of profiling run
+ * @param program profiled program with map of source lines
+ * @param report output stream
+*/
+static void profile_report_lines(interpreter_profile_t *profile, interpreter_program_t *program, FILE *report){
+    unsigned last = 0;
+    for(unsigned i = 0; i < program->instruction_count; i++){
+        if(program->source_lines[i] > last){
+            last = program->source_lines[i];
+        }
+    }
+
+    unsigned long long *lines = calloc(last + 1, sizeof(unsigned long long));
+    const unsigned long long **order = malloc((last + 1) * sizeof(unsigned long long *));
+    if(lines == NULL || order == NULL){
+        print_error(ERR_INTERNAL, "profile: allocation failed\n");
+        free(lines);
+        free(order);
+        return;
+    }
+
+    for(unsigned i = 0; i < program->instruction_count; i++){
+        lines[program->source_lines[i]] += profile->instructions[i];
+    }
+
+    fprintf(report, "\n%-12s %12s %8s\n", "source line", "dispatches", "%");
+    unsigned ordered = 0;
+    for(unsigned line = 1; line <= last; line++){
+        if(lines[line] > 0){
+            order[ordered++] = &lines[line];
+        }
+    }
+    qsort(order, ordered, sizeof(unsigned long long *), profile_count_compare);
+    for(unsigned i = 0; i < ordered; i++){
+        fprintf(report, "%-12u %12llu %8.2f\n", (unsigned)(order[i] - lines), *order[i], profile_percent(profile, *order[i]));
+    }
+
+    free(lines);
+    free(order);
+}
+
+bool interpreter_profile_init(interpreter_profile_t *profile, interpreter_program_t *program){
+    profile->instructions = calloc(program->instruction_count + 1, sizeof(unsigned long long));
+    profile->calls = calloc(program->instruction_count + 1, sizeof(unsigned long long));
+    profile->dispatches = 0;
+
+    if(profile->instructions == NULL || profile->calls == NULL){
+        interpreter_profile_dispose(profile);
+        return false;
+    }
+    return true;
+}
+
+void interpreter_profile_dispose(interpreter_profile_t *profile){
+    free(profile->instructions);
+    free(profile->calls);
+    profile->instructions = NULL;
+    profile->calls = NULL;
+}
+
+void interpreter_profile_report(interpreter_profile_t *profile, interpreter_program_t *program, FILE *report){
+    unsigned count = program->instruction_count;
+
+    // names of labels by position of LABEL instructions
+    const char **labels = calloc(count + 1, sizeof(const char *));
+    profile_region_t *regions = calloc(count + 1, sizeof(profile_region_t));
+    unsigned *stack = malloc((count + 1) * sizeof(unsigned));
+    const unsigned long long **order = malloc((count + OP_UNKNOWN + 1) * sizeof(unsigned long long *));
+    unsigned long long opcodes[OP_UNKNOWN] = {0};
+
+    if(labels == NULL || regions == NULL || stack == NULL || order == NULL){
+        print_error(ERR_INTERNAL, "profile: allocation failed\n");
+        free(labels);
+        free(regions);
+        free(stack);
+        free(order);
+        return;
+    }
+
+    for(unsigned id = 0; id < program->labels.count; id++){
+        if(program->label_positions[id] != INTERPRETER_NO_INDEX){
+            labels[program->label_positions[id]] = program->labels.names[id];
+        }
+    }
+
+    // regions are nested by labels ending them, functions end all regions
+    unsigned region_count = 1;
+    unsigned depth = 1;
+    unsigned function = 0;
+    char end[256];
+    stack[0] = 0;
+
+    for(unsigned i = 0; i < count; i++){
+        const char *label = labels[i];
+
+        if(label != NULL && strncmp(label, "$$FUNCTION_", strlen("$$FUNCTION_")) == 0){
+            function = region_count;
+            regions[region_count].label = label;
+            regions[region_count].function = function;
+            stack[0] = region_count++;
+            depth = 1;
+        } else if(label != NULL && strcmp(label, "$$EOF") == 0){
+            function = 0;
+            stack[0] = 0;
+            depth = 1;
+        } else if(label != NULL && profile_region_label(label, end, sizeof(end))){
+            regions[region_count].label = label;
+            regions[region_count].function = function;
+            stack[depth++] = region_count++;
+        } else if(label != NULL){
+            // end of region (regions between it and its start are ended too)
+            for(unsigned d = depth; d > 1; d--){
+                profile_region_label(regions[stack[d - 1]].label, end, sizeof(end));
+                if(strcmp(end, label) == 0){
+                    depth = d - 1;
+                    break;
+                }
+            }
+        }
+
+        unsigned long long dispatches = profile->instructions[i];
+        opcodes[program->instructions[i].opcode] += dispatches;
+        regions[stack[depth - 1]].self += dispatches;
+        for(unsigned d = 0; d < depth; d++){
+            regions[stack[d]].total += dispatches;
+        }
+    }
+
+    fprintf(report, "Dispatched instructions: %llu\n\n", profile->dispatches);
+
+    fprintf(report, "%-12s %12s %8s\n", "opcode", "dispatches", "%");
+    unsigned ordered = 0;
+    for(unsigned i = 0; i < OP_UNKNOWN; i++){
+        if(opcodes[i] > 0){
+            order[ordered++] = &opcodes[i];
+        }
+    }
+    qsort(order, ordered, sizeof(unsigned long long *), profile_count_compare);
+    for(unsigned i = 0; i < ordered; i++){
+        unsigned long long dispatches = *order[i];
+        fprintf(report, "%-12s %12llu %8.2f\n", instruction_table[order[i] - opcodes].name, dispatches, profile_percent(profile, dispatches));
+    }
+
+    fprintf(report, "\n%-24s %12s %12s %8s  %s\n", "region", "total", "self", "%", "source");
+    ordered = 0;
+    for(unsigned i = 0; i < region_count; i++){
+        if(regions[i].total > 0){
+            order[ordered++] = &regions[i].total;
+        }
+    }
+    qsort(order, ordered, sizeof(unsigned long long *), profile_count_compare);
+    for(unsigned i = 0; i < ordered; i++){
+        profile_region_t *region = (profile_region_t *)((const char *)order[i] - offsetof(profile_region_t, total));
+        char source[512];
+        profile_region_source(regions, region, source, sizeof(source));
+        fprintf(report, "%-24s %12llu %12llu %8.2f  %s\n", region->label == NULL ? "(main)" : region->label,
+                region->total, region->self, profile_percent(profile, region->total), source);
+    }
+
+    fprintf(report, "\n%-24s %8s %12s %12s %8s\n", "call site", "line", "calls", "total", "%");
+    ordered = 0;
+    for(unsigned i = 0; i < count; i++){
+        if(program->instructions[i].opcode == OP_CALL && profile->instructions[i] > 0){
+            order[ordered++] = &profile->calls[i];
+        }
+    }
+    qsort(order, ordered, sizeof(unsigned long long *), profile_count_compare);
+    for(unsigned i = 0; i < ordered; i++){
+        unsigned position = order[i] - profile->calls;
+        unsigned target = program->instructions[position].operands[0].index;
+        fprintf(report, "%-24s %8u %12llu %12llu %8.2f\n", target == INTERPRETER_NO_INDEX ? "?" : labels[target],
+                program->instructions[position].line, profile->instructions[position], profile->calls[position],
+                profile_percent(profile, profile->calls[position]));
+    }
+
+    if(program->source_lines != NULL){
+        profile_report_lines(profile, program, report);
+    }
+
+    free(labels);
+    free(regions);
+    free(stack);
+    free(order);
+}
+
+#ifdef INTERPRETER_MAIN
+/**
+ * Reads whole binary container
+ * @param source opened container
+ * @param size size of read content
+ * @return content or NULL on allocation error
+*/
+static unsigned char *main_read_binary(FILE *source, size_t *size){
+    size_t capacity = 4096;
+    unsigned char *data = malloc(capacity);
+    *size = 0;
+
+    size_t read = 0;
+    while(data != NULL && (read = fread(data + *size, 1, capacity - *size, source)) > 0){
+        *size += read;
+        if(*size == capacity){
+            unsigned char *resized = realloc(data, capacity * 2);
+            if(resized == NULL){
+                free(data);
+                return NULL;
+            }
+            data = resized;
+            capacity *= 2;
+        }
+    }
+    return data;
+}
+
+/**
+ * Prints text form of binary container
+ * @param data content of container
+ * @param size size of content
+ * @return 0 or ERR_RUN_SOURCE
+*/
+static int main_print_text(const unsigned char *data, size_t size){
+    code_binary_t binary;
+    code_buffer_t code;
+    code_buffer_init(&code);
+
+    bool valid = code_binary_open(&binary, data, size) && code_binary_read(&binary, &code);
+    if(valid){
+        printf("%s\n", HEADER);
+        code_buffer_print(&code, stdout);
+    } else {
+        print_error(ERR_RUN_SOURCE, "invalid binary IFJcode23\n");
+    }
+
+    code_buffer_dispose(&code);
+    code_binary_close(&binary);
+    return valid ? 0 : ERR_RUN_SOURCE;
+}
+
+int main(int argc, char *argv[]){
+    bool debug = true;
+    bool text = false;
+    const char *path = NULL;
+    const char *report_path = NULL;
+    const char *map_path = NULL;
+
+    for(int i = 1; i < argc; i++){
+        if(strcmp(argv[i], "-s") == 0 || strcmp(argv[i], "--silent") == 0){
+            debug = false;
+        } else if((strcmp(argv[i], "-p") == 0 || strcmp(argv[i], "--profile") == 0) && i + 1 < argc){
+            report_path = argv[++i];
+        } else if((strcmp(argv[i], "-m") == 0 || strcmp(argv[i], "--line-map") == 0) && i + 1 < argc){
+            map_path = argv[++i];
+        } else if(strcmp(argv[i], "-t") == 0 || strcmp(argv[i], "--text") == 0){
+            text = true;
+        } else {
+            path = argv[i];
+        }
+    }
+
+    if(path == NULL){
+        fprintf(stderr, "Usage: %s [-s|--silent] [-p|--profile report] [-m|--line-map map] [-t|--text] file\n", argv[0]);
+        return ERR_INTERNAL;
+    }
+
+    FILE *source = fopen(path, "rb");
+    if(source == NULL){
+        print_error(ERR_INTERNAL, "can not open %s\n", path);
+        return ERR_INTERNAL;
+    }
+
+    // binary container is recognized by its magic
+    char magic[CODE_BINARY_MAGIC_LENGTH];
+    bool binary = fread(magic, 1, CODE_BINARY_MAGIC_LENGTH, source) == CODE_BINARY_MAGIC_LENGTH &&
+                  memcmp(magic, CODE_BINARY_MAGIC, CODE_BINARY_MAGIC_LENGTH) == 0;
+    rewind(source);
+
+    interpreter_program_t program;
+    interpreter_program_init(&program);
+    int result = 0;
+
+    if(binary){
+        size_t size = 0;
+        unsigned char *data = main_read_binary(source, &size);
+        if(data == NULL){
+            result = ERR_INTERNAL;
+        } else if(text){
+            // only text form is printed
+            result = main_print_text(data, size);
+            free(data);
+            fclose(source);
+            return result;
+        } else {
+            result = interpreter_load_binary(&program, data, size);
+        }
+        free(data);
+    } else if(text){
+        print_error(ERR_RUN_SOURCE, "%s is not binary IFJcode23\n", path);
+        fclose(source);
+        return ERR_RUN_SOURCE;
+    } else {
+        result = interpreter_load(&program, source);
+    }
+    fclose(source);
+
+    if(result == 0 && map_path != NULL){
+        FILE *map = fopen(map_path, "r");
+        if(map == NULL){
+            print_error(ERR_INTERNAL, "can not open %s\n", map_path);
+            result = ERR_INTERNAL;
+        } else {
+            result = interpreter_load_line_map(&program, map);
+            fclose(map);
+        }
+    }
+
+    interpreter_profile_t profile;
+    bool profiled = false;
+    if(result == 0 && report_path != NULL){
+        if(!interpreter_profile_init(&profile, &program)){
+            result = ERR_INTERNAL;
+        }
+        profiled = result == 0;
+    }
+
+    if(result == 0){
+        result = interpreter_run(&program, stdin, stdout, debug, profiled ? &profile : NULL);
+    }
+
+    if(profiled){
+        // report is written even if program ended by error
+        FILE *report = strcmp(report_path, "-") == 0 ? stderr : fopen(report_path, "w");
+        if(report != NULL){
+            interpreter_profile_report(&profile, &program, report);
+            if(report != stderr){
+                fclose(report);
+            }
+        } else {
+            print_error(ERR_INTERNAL, "can not open %s\n", report_path);
+        }
+        interpreter_profile_dispose(&profile);
+    }
+
+    interpreter_program_dispose(&program);
+    return result;
+}
+#endif
@@ -31,8 +31,10 @@ char unread = '\0'; //char which was unread
 
 token_T actual_token; //actual token generated by automat
 
-unsigned actual_line = 1;   //FOR DEBUG
-unsigned actual_column = 0; //FOR DEBUG
+unsigned actual_line = 1;   //position of last read char
+unsigned actual_column = 0;
+unsigned previous_line = 1; //position of char read before last one
+unsigned previous_column = 0;
 
 int open_comments = 0; //count of opened multiline comments
 int hexa_string = 0;   //count of chars in hex escapes
@@ -470,18 +472,26 @@ int get_token(token_T *token)
     
     do {
         if (unread == '\0') {
+            previous_line   = actual_line;
+            previous_column = actual_column;
             read = fgetc(stdin);
             actual_column++;
 
             if (read == '\n') {
                 actual_line++;
-                actual_column =1;
+                actual_column = 0;
             }
         } else {
             read = unread;
             unread = '\0';
         }
 
+        // token starts by last char processed in start state
+        if (actual_state == start) {
+            actual_token.span.line   = actual_line;
+            actual_token.span.column = actual_column;
+        }
+
         actual_state(read);
 
         if (malloc_error == true) return ERR_INTERNAL;
@@ -508,9 +518,14 @@ int get_token(token_T *token)
         return ERR_LEXICAL;
     }
 
+    // lookahead char, which was returned back, does not belong to token
+    actual_token.span.end_line   = unread != '\0' ? previous_line   : actual_line;
+    actual_token.span.end_column = unread != '\0' ? previous_column : actual_column;
+
     token->preceding_eol = actual_token.preceding_eol;
     token->type  = actual_token.type;
     token->value = actual_token.value;
+    token->span  = actual_token.span;
 
     return ERR_NO_ERR;
 }
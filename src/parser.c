@@ -13,66 +13,73 @@
 Rule prog(Parser* p) {
     RULE_PRINT("prog");
     uint32_t res, err;
-    DEBUG_PRINT("current: %d", p->curr_tok.type);
 
-    switch (p->curr_tok.type) {
-    case TOKEN_EOF:
-        code_generator_eof();
-        break;
-    case TOKEN_FUNC:
-        CHECK_NEWLINE();
-        p->in_func_head = true;
-        GET_TOKEN();
-        ASSERT_TOK_TYPE(TOKEN_IDENTIFIER);
-        p->last_func_id = symtable_search(&p->global_symtab, &p->curr_tok.value.string_val, &err);
-        /* Generate label for function */
-        code_generator_function_label_token(p->curr_tok);
-
-        GET_TOKEN();
-        ASSERT_TOK_TYPE(TOKEN_L_PAR);
-        /* new scope for parameters */
-        add_scope(&p->stack, &err);
-        /* Reset param counter before parsing function parameters */
-        p->param_cnt = 0;
-        GET_TOKEN();
-        NEXT_RULE(param_list_skip);
-
-        GET_TOKEN();
-        NEXT_RULE(func_ret_type_skip);
-        p->in_func_head = false;
-        p->in_func_body = true;
-        ASSERT_TOK_TYPE(TOKEN_L_BKT);
-
-        GET_TOKEN();
-        p->first_stmt = true;
-        /* new scope for body */
-        add_scope(&p->stack, &err);
-        NEXT_RULE(func_body);
-        /* pop the parameter scope */
-        pop_scope(&p->stack, &err);
-        p->in_func_body = false;
-        p->first_stmt = false;
-        code_generator_function_end(p->last_func_id->name.str);
-        GET_TOKEN();
-        NEXT_RULE(prog);
-        break;
-    default:
-        NEXT_RULE(stmt);
-        p->first_stmt = false;
-        NEXT_RULE(prog);
-        break;
+    /* statements and functions are parsed in a loop, call depth does not grow with program length */
+    while (p->curr_tok.type != TOKEN_EOF) {
+        DEBUG_PRINT("current: %d", p->curr_tok.type);
+
+        switch (p->curr_tok.type) {
+        case TOKEN_FUNC:
+            CHECK_NEWLINE();
+            code_generator_source_position(p->curr_tok);
+            p->in_func_head = true;
+            GET_TOKEN();
+            ASSERT_TOK_TYPE(TOKEN_IDENTIFIER);
+            p->last_func_id = symtable_search(&p->global_symtab, &p->curr_tok.value.string_val, &err);
+            /* Generate label for function */
+            code_generator_function_label_token(p->curr_tok);
+
+            GET_TOKEN();
+            ASSERT_TOK_TYPE(TOKEN_L_PAR);
+            /* new scope for parameters */
+            add_scope(&p->stack, &err);
+            /* Reset param counter before parsing function parameters */
+            p->param_cnt = 0;
+            GET_TOKEN();
+            NEXT_RULE(param_list_skip);
+
+            GET_TOKEN();
+            NEXT_RULE(func_ret_type_skip);
+            p->in_func_head = false;
+            p->in_func_body = true;
+            ASSERT_TOK_TYPE(TOKEN_L_BKT);
+
+            GET_TOKEN();
+            p->first_stmt = true;
+            /* new scope for body */
+            add_scope(&p->stack, &err);
+            NEXT_RULE(func_body);
+            /* pop the parameter scope */
+            pop_scope(&p->stack, &err);
+            p->in_func_body = false;
+            p->first_stmt = false;
+            code_generator_function_end(p->last_func_id->name.str);
+            GET_TOKEN();
+            break;
+        default:
+            NEXT_RULE(stmt);
+            p->first_stmt = false;
+            break;
+        }
+        RULE_PRINT("prog");
     }
+
+    code_generator_eof();
     return EXIT_SUCCESS;
 }
 
 Rule stmt(Parser* p) {
     RULE_PRINT("stmt");
     uint32_t res, err;
+    /* first token of statement is source position of generated code (also of code closing loop or condition) */
+    token_T stmt_tok = p->curr_tok;
+    code_generator_source_position(stmt_tok);
 
     switch (p->curr_tok.type) {
     case TOKEN_VAR: /* var <define> */
         CHECK_NEWLINE();
         GET_TOKEN();
+        p->in_let = false;
         NEXT_RULE(define);
         p->lhs_id->is_mutable = true;
         p->lhs_id = NULL;
@@ -80,6 +87,7 @@ Rule stmt(Parser* p) {
     case TOKEN_LET: /* let <define> */
         CHECK_NEWLINE();
         GET_TOKEN();
+        p->in_let = true;
         NEXT_RULE(define);
         p->lhs_id->is_mutable = false;
         p->lhs_id = NULL;
@@ -122,6 +130,7 @@ Rule stmt(Parser* p) {
         code_generator_for_body(closing_loop_uid);
         NEXT_RULE(block_body);
         GET_TOKEN();
+        code_generator_source_position(stmt_tok);
         code_generator_for_loop_end(closing_loop_uid);
         p->in_loop--;
         break;
@@ -146,6 +155,7 @@ Rule stmt(Parser* p) {
         /* Add a local scope for else body */
         add_scope(&p->stack, &err);
         /* Generate else body */
+        code_generator_source_position(stmt_tok);
         code_generator_if_else(closing_uid);
         GET_TOKEN();
         ASSERT_TOK_TYPE(TOKEN_L_BKT);
@@ -153,6 +163,7 @@ Rule stmt(Parser* p) {
         p->first_stmt = true;
         NEXT_RULE(block_body);
         GET_TOKEN();
+        code_generator_source_position(stmt_tok);
         code_generator_if_end(closing_uid);
         p->in_cond--; // condition should be fully parsed by the time we're exiting the switch statement
         break;
@@ -198,6 +209,8 @@ Rule define(Parser* p) {
         p->current_id = symtable_search(&p->global_symtab, &p->curr_tok.value.string_val, &err);
     }
     p->current_id->is_var_initialized = false;
+    /* Mutability is known before generating code of the declaration */
+    p->current_id->is_mutable = !p->in_let;
     p->lhs_id = p->current_id;
     GET_TOKEN();
     NEXT_RULE(var_def_cont);
@@ -480,6 +493,8 @@ Rule expr_type(Parser* p) {
         p->last_func_id = p->current_id;
         p->current_id = NULL;
         p->in_function = true;
+        /* Function calling itself can not be inlined by code generator */
+        if (p->in_func_body && temp == p->last_func_id) p->last_func_id->is_recursive = true;
 
         GET_TOKEN();
         NEXT_RULE(arg_list);
@@ -779,54 +794,53 @@ Rule block_body(Parser* p) {
     RULE_PRINT("block_body");
     uint32_t res, err;
 
-    if (p->curr_tok.type == TOKEN_R_BKT) {
-        DEBUG_PRINT("block_body end }");
-        pop_scope(&p->stack, &err);
-        return EXIT_SUCCESS;
-    }
-    else {
+    while (p->curr_tok.type != TOKEN_R_BKT) {
         NEXT_RULE(stmt);
         p->first_stmt = false;
-        NEXT_RULE(block_body);
+        RULE_PRINT("block_body");
     }
+
+    DEBUG_PRINT("block_body end }");
+    pop_scope(&p->stack, &err);
     return EXIT_SUCCESS;
 }
 
 Rule func_body(Parser* p) {
     RULE_PRINT("func_body");
     uint32_t res, err;
-    DEBUG_PRINT("token::%d", p->curr_tok.type);
-    if (p->curr_tok.type == TOKEN_R_BKT) {
-        if (p->in_cond == 0 && p->in_loop == 0) {
-            if (p->last_func_id->return_type != nil) {
-                if (p->return_found == false) {
-                    fprintf(stderr, "[ERROR %d] Missing return statement in function '%s'\n", ERR_RETURN_TYPE, p->last_func_id->name.str);
-                    return ERR_RETURN_TYPE;
-                }
-            }
-        }
-        p->return_found = false;
-        pop_scope(&p->stack, &err);
-        DEBUG_PRINT("Closing body");
-        return EXIT_SUCCESS;
-    }
-    else {
+    while (p->curr_tok.type != TOKEN_R_BKT) {
+        DEBUG_PRINT("token::%d", p->curr_tok.type);
         NEXT_RULE(func_stmt);
         p->first_stmt = false;
-        NEXT_RULE(func_body);
+        RULE_PRINT("func_body");
     }
 
+    if (p->in_cond == 0 && p->in_loop == 0) {
+        if (p->last_func_id->return_type != nil) {
+            if (p->return_found == false) {
+                fprintf(stderr, "[ERROR %d] Missing return statement in function '%s'\n", ERR_RETURN_TYPE, p->last_func_id->name.str);
+                return ERR_RETURN_TYPE;
+            }
+        }
+    }
+    p->return_found = false;
+    pop_scope(&p->stack, &err);
+    DEBUG_PRINT("Closing body");
     return EXIT_SUCCESS;
 }
 
 Rule func_stmt(Parser* p) {
     RULE_PRINT("func_stmt");
     uint32_t res, err;
+    /* first token of statement is source position of generated code (also of code closing loop or condition) */
+    token_T stmt_tok = p->curr_tok;
+    code_generator_source_position(stmt_tok);
 
     switch (p->curr_tok.type) {
     case TOKEN_VAR:
         CHECK_NEWLINE();
         GET_TOKEN();
+        p->in_let = false;
         NEXT_RULE(define);
         p->lhs_id->is_mutable = true;
         p->lhs_id = NULL;
@@ -834,6 +848,7 @@ Rule func_stmt(Parser* p) {
     case TOKEN_LET:
         CHECK_NEWLINE();
         GET_TOKEN();
+        p->in_let = true;
         NEXT_RULE(define);
         p->lhs_id->is_mutable = false;
         p->lhs_id = NULL;
@@ -876,6 +891,7 @@ Rule func_stmt(Parser* p) {
         code_generator_for_body(closing_loop_uid);
         NEXT_RULE(func_body);
         GET_TOKEN();
+        code_generator_source_position(stmt_tok);
         code_generator_for_loop_end(closing_loop_uid);
         p->in_loop--;
         break;
@@ -900,6 +916,7 @@ Rule func_stmt(Parser* p) {
         /* Add a local scope for else body */
         add_scope(&p->stack, &err);
         /* Generate else body */
+        code_generator_source_position(stmt_tok);
         code_generator_if_else(closing_uid);
         GET_TOKEN();
         ASSERT_TOK_TYPE(TOKEN_L_BKT);
@@ -907,6 +924,7 @@ Rule func_stmt(Parser* p) {
         p->first_stmt = true;
         NEXT_RULE(func_body);
         GET_TOKEN();
+        code_generator_source_position(stmt_tok);
         code_generator_if_end(closing_uid);
         p->in_cond--;
         break;
@@ -1293,20 +1311,17 @@ Rule func_ret_type_skip(Parser* p) {
 
 Rule skip(Parser* p) {
     uint32_t res;
-    if (p->curr_tok.type == TOKEN_EOF) {
-        DEBUG_PRINT("leaving with EOF");
-        return EXIT_SUCCESS;
-    }
-    if (p->curr_tok.type == TOKEN_FUNC) {
-        NEXT_RULE(func_header);
+    while (p->curr_tok.type != TOKEN_EOF) {
+        if (p->curr_tok.type == TOKEN_FUNC) {
+            NEXT_RULE(func_header);
+        }
+        else {
+            DEBUG_PRINT("skipping token: %d", p->curr_tok.type);
+        }
         GET_TOKEN();
-        NEXT_RULE(skip);
-        return EXIT_SUCCESS;
     }
-    DEBUG_PRINT("skipping token: %d", p->curr_tok.type);
-    GET_TOKEN();
-    NEXT_RULE(skip);
 
+    DEBUG_PRINT("leaving with EOF");
     return EXIT_SUCCESS;
 }
 
@@ -1321,6 +1336,8 @@ Rule funccall(Parser* p) {
 
     temp = p->last_func_id;
     p->last_func_id = p->rhs_id;
+    /* Function calling itself can not be inlined by code generator */
+    if (p->in_func_body && temp == p->last_func_id) p->last_func_id->is_recursive = true;
     GET_TOKEN();
     NEXT_RULE(arg_list);
     code_generator_function_call(p->last_func_id->name.str);
@@ -1353,6 +1370,7 @@ bool parser_init(Parser* p) {
     p->in_function = false;
     p->return_found = false;
     p->first_stmt = true;
+    p->in_let = false;
     p->in_loop = 0;
     p->in_param = false;
     p->expr_res.expr_type = undefined;
@@ -1372,6 +1390,7 @@ void parser_dispose(Parser* p) {
     symtable_dispose(&p->global_symtab);
     dispose_scope(&p->stack, &err);
     tb_dispose(&p->buffer);
+    code_generator_dispose();
 }
 
 bool add_builtins(Parser* p) {
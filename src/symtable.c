@@ -149,6 +149,7 @@ symtab_item_t *item_init(dstring_t *id, unsigned int *error)
     new->is_var_initialized = false;
     new->is_nillable = false;
     new->variadic_param = false;
+    new->is_recursive = false;
     new->parameters = NULL;
     new->return_type = undefined;
 
@@ -14,6 +14,7 @@
 void tb_init(token_buffer_t* buffer) {
     buffer->head = NULL;
     buffer->runner = buffer->head;
+    buffer->tail = NULL;
 }
 
 int tb_push(token_buffer_t* buffer, token_T token) {
@@ -33,13 +34,10 @@ int tb_push(token_buffer_t* buffer, token_T token) {
         buffer->runner = buffer->head;
     }
     else {
-        token_buffer_node_t current = buffer->runner;
-        while (current->next != NULL) {
-            current = current->next;
-        }
-        current->next = new_node;
-        new_node->prev = current;
+        buffer->tail->next = new_node;
+        new_node->prev = buffer->tail;
     }
+    buffer->tail = new_node;
 
     return EXIT_SUCCESS;
 }
@@ -57,6 +55,9 @@ void tb_pop(token_buffer_t* buffer) {
         if(buffer->runner == buffer->head) {
             buffer->head = current->next;
         }
+        if(current == buffer->tail) {
+            buffer->tail = current->prev;
+        }
         buffer->runner = current->next;
         if (current->token.type == TOKEN_STRING || current->token.type == TOKEN_IDENTIFIER)
             dstring_free(&current->token.value.string_val);
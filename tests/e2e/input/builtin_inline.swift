@@ -0,0 +1,43 @@
+let e = ""
+let s = "Hello world"
+var o = ord(e)
+write(o, "\n")
+o = ord("A")
+write(o, "\n")
+o = ord("")
+write(o, "\n")
+o = ord(s)
+write(o, "\n")
+var a : String? = substring(of: s, startingAt: 0, endingBefore: 5)
+write(a, "\n")
+a = substring(of: "abc#de f", startingAt: 2, endingBefore: 7)
+write(a, "\n")
+a = substring(of: s, startingAt: 3, endingBefore: 2)
+write(a, "\n")
+a = substring(of: s, startingAt: 0, endingBefore: 12)
+write(a, "\n")
+a = substring(of: "abc", startingAt: 3, endingBefore: 3)
+write(a, "\n")
+var i = 0
+while (i < 11) {
+    var j = i + 1
+    let c = substring(of: s, startingAt: i, endingBefore: j)
+    if let c {
+        o = ord(c)
+        write(c, o, "|")
+    } else {
+    }
+    i = i + 1
+}
+write("\n")
+func f(_ x : String, _ k : Int) -> String? {
+    let r = substring(of: x, startingAt: k, endingBefore: 11)
+    return r
+}
+let m = 0 - 1
+a = f(s, 6)
+write(a, "\n")
+a = f(s, m)
+write(a, "\n")
+a = substring(of: s, startingAt: i, endingBefore: i)
+write(a, "\n")
@@ -0,0 +1,14 @@
+var a : Int? = 4
+var b = 3
+var c = (a ?? 0) * b + (a ?? 0) * b
+write(c, "\n")
+var d = b * 2
+var e = b * 2 - 1
+write(d, " ", e, "\n")
+b = b + 1
+var f = b * 2 + b * 2
+write(f, "\n")
+let s = "ab"
+var t = s + "c"
+t = s + "c" + t
+write(t, "\n")
@@ -0,0 +1,42 @@
+func fib(_ n : Int) -> Int {
+    if n < 2 {
+        return n
+    } else {
+    }
+    let a = n - 1
+    let b = n - 2
+    let x = fib(a)
+    let y = fib(b)
+    return x + y
+}
+func greet(_ name : String, times k : Int) -> String {
+    var s = ""
+    var i = 0
+    while i < k {
+        s = s + name + " "
+        i = i + 1
+    }
+    return s
+}
+func spin(_ n : Int) -> Int {
+    var i = 0
+    while i < n {
+        i = i + 1
+    }
+    return i
+}
+func half(_ x : Double) -> Double {
+    return x / 2.0
+}
+let f = fib(15)
+write(f, "\n")
+let g = greet("hi#\\", times: 3)
+write(g, "\n")
+let s = spin(1000000)
+write(s, "\n")
+let h = half(3.0)
+write(h, "\n")
+let r = readInt()
+let rr = r!
+let q = fib(rr)
+write(q, "\n")
@@ -0,0 +1,37 @@
+let a = "A"
+var b = "B"
+var i = 0
+var s = ""
+let c = "C"
+let d = a + b + c + "x" + "y" + "\n"
+write(d)
+let e = "lit" + "eral" + a + "\n"
+write(e)
+var f = a + (b + c)
+f = (a + b) + (c + a)
+write(f, "\n")
+let g : String? = nil
+let h = (g ?? "n") + a
+write(h, "\n")
+while (i < 3) {
+    s = s + a + "-"
+    i = i + 1
+}
+write(s, "\n")
+let j = "p" + ("q" + b + c)
+write(j, "\n")
+let k = b + (c + (a + "z"))
+write(k, "\n")
+let l = ("1" + "2") + ("3" + a)
+write(l, "\n")
+i = 0
+s = ""
+while (i < 3) {
+    let t = b + "-" + a
+    s = s + t
+    i = i + 1
+}
+write(s, "\n")
+let u = b + "x"
+let v = b + "x"
+write(u, v, "\n")
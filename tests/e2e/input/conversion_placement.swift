@@ -0,0 +1,21 @@
+let x = 2.5
+let a = 1 + x
+write(a, "\n")
+let b = x * 4
+write(b, "\n")
+let c : Double = 3 + 4
+write(c, "\n")
+let d = (2 + 3) * x
+write(d, "\n")
+let e = x - (10 - 4)
+write(e, "\n")
+let n : Double? = nil
+let f = n ?? 7
+write(f, "\n")
+let g = x < 3
+if (g) { write("lt\n") } else { write("ge\n") }
+if (x > 2) { write("gt\n") } else {}
+let h = 1 + (x * 2)
+write(h, "\n")
+let k = 2 * x + 1
+write(k, "\n")
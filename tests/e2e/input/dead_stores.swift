@@ -0,0 +1,44 @@
+var total : Int?
+var unused : Int? = 5
+var limit = 3
+
+func count(_ n : Int) -> Int {
+    var last : Int?
+    if n > limit {
+        return 0
+    } else {
+        last = n
+    }
+    let next = n + 1
+    let rest = count(next)
+    let value = last!
+    return value + rest
+}
+
+total = count(1)
+write(total, "\n")
+
+var best : Int?
+var i = 0
+while i < 4 {
+    if i == 2 {
+        best = i
+    } else {
+    }
+    i = i + 1
+}
+write(best, "\n")
+
+var label : String?
+if i > 2 {
+    label = "many"
+} else {
+    label = "few"
+}
+write(label, "\n")
+
+var maybe : Int?
+write(maybe, "\n")
+limit = 1
+let again = count(1)
+write(again, "\n")
@@ -0,0 +1,24 @@
+var a = 3
+var b = 5
+var n : Int? = nil
+if (a < b) { write("lt ") } else { write("!lt ") }
+if (a <= b) { write("le ") } else { write("!le ") }
+if (a > b) { write("gt ") } else { write("!gt ") }
+if (a >= b) { write("ge ") } else { write("!ge ") }
+if (a == b) { write("eq ") } else { write("!eq ") }
+if (a != b) { write("ne\n") } else { write("!ne\n") }
+if (a + 2 == b) { write("sum ") } else { write("!sum ") }
+if (a * 2 != b + 1) { write("prod ") } else { write("!prod ") }
+if (a * 2 >= b + 1) { write("ge2 ") } else { write("!ge2 ") }
+if (n == nil) { write("nil\n") } else { write("!nil\n") }
+var s = "ab"
+if (s + "c" == "abc") { write("str ") } else { write("!str ") }
+if (s != "ab") { write("strne\n") } else { write("!strne\n") }
+var i = 0
+while (i != 4) {
+    i = i + 1
+}
+while (i >= 2) {
+    i = i - 1
+}
+write(i, "\n")
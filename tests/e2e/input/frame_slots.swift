@@ -0,0 +1,43 @@
+func stats(_ n : Int) -> Int {
+    var total = 0
+    var i = 0
+    while (i < n) {
+        let square = i * i
+        let half = square / 2
+        total = total + half
+        i = i + 1
+    }
+    let first = total + 1
+    let second = first * 2
+    var third = second - 3
+    if (third > 100) {
+        let big = third - 100
+        let bigger = big * 2
+        third = bigger
+    } else {
+        let small = third + 100
+        let smaller = small / 2
+        third = smaller
+    }
+    var pending : Int?
+    let last = third + 0
+    let text = "done "
+    write(text)
+    let label = pending ?? last
+    return label
+}
+
+func join(_ a : String, _ b : String) -> String {
+    let left = a + "-"
+    let both = left + b
+    let twice = both + both
+    let tail = twice + "|"
+    return tail
+}
+
+let x = stats(10)
+write(x, "\n")
+let y = stats(3)
+write(y, "\n")
+let z = join("ab", "cd")
+write(z, "\n")
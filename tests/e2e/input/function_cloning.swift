@@ -0,0 +1,78 @@
+func step(_ x : Int, by k : Int, mode m : Int) -> Int {
+    var r = x
+    if m == 1 {
+        r = r + k
+    } else {
+        r = r * k
+    }
+    if m > 2 {
+        r = r - 1
+    } else {
+        r = r + 0
+    }
+    write("step ", x, " by ", k, " mode ", m, " is ", r, "\n")
+    return r
+}
+func scale(_ x : Double, factor f : Double, verbose v : Int) -> Double {
+    let y = x * f
+    write("scale ", x, " by ", f, "\n")
+    write("  again scale ", x, " by ", f, "\n")
+    write("  and again scale ", x, " by ", f, "\n")
+    write("  once more scale ", x, " by ", f, "\n")
+    if v == 1 {
+        write("scaled ", x, " ", y, "\n")
+    } else {
+    }
+    return y
+}
+func label(_ s : String, prefix p : String) -> String {
+    var r = s
+    if p == "" {
+        r = "none:" + s
+    } else {
+        r = p + s
+    }
+    write("label ", s, " with ", p, " is ", r, "\n")
+    write("  again label ", s, " with ", p, " is ", r, "\n")
+    write("  and again label ", s, " with ", p, " is ", r, "\n")
+    write("  once more label ", s, " with ", p, " is ", r, "\n")
+    return r
+}
+func countdown(_ n : Int, limit l : Int) -> Int {
+    var i = n
+    var c = 0
+    while i > l {
+        i = i - 1
+        c = c + 1
+    }
+    write("countdown ", n, " to ", l, " is ", c, "\n")
+    write("  again countdown ", n, " to ", l, " is ", c, "\n")
+    return c
+}
+var a = 1
+var i = 0
+while i < 5 {
+    a = step(a, by: 2, mode: 1)
+    i = i + 1
+}
+write(a, "\n")
+a = step(a, by: 3, mode: 1)
+a = step(a, by: 3, mode: 2)
+a = step(a, by: 3, mode: 3)
+write(a, "\n")
+var d = 1.5
+d = scale(d, factor: 2.0, verbose: 0)
+d = scale(d, factor: 3.0, verbose: 0)
+d = scale(d, factor: 0.5, verbose: 1)
+write(d, "\n")
+var s = "x"
+s = label(s, prefix: "")
+s = label(s, prefix: "")
+s = label(s, prefix: "p-")
+write(s, "\n")
+var n = countdown(10, limit: 0)
+write(n, "\n")
+n = countdown(n, limit: 0)
+write(n, "\n")
+n = countdown(n, limit: 20)
+write(n, "\n")
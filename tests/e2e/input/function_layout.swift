@@ -0,0 +1,22 @@
+func fib(_ n : Int) -> Int {
+    var result = n
+    if (n < 2) {
+    } else {
+        let n1 = n - 1
+        let n2 = n - 2
+        let a = fib(n1)
+        let b = fib(n2)
+        result = a + b
+    }
+    return result
+}
+write("start\n")
+func hello(_ s : String) {
+    write("hello ", s, "\n")
+}
+hello("x")
+let r = fib(10)
+write(r, "\n")
+let c = "A"
+let o = ord(c)
+write(o, "\n")
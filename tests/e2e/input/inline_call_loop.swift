@@ -0,0 +1,34 @@
+func sq(_ x : Int) -> Int {
+    let r = x * x
+    return r
+}
+
+func clamp(_ x : Int, max m : Int) -> Int {
+    if (x > m) {
+        return m
+    } else {}
+    return x
+}
+
+func sum(_ n : Int) -> Int {
+    if (n == 0) {
+        return 0
+    } else {}
+    let k = n - 1
+    let s = sum(k)
+    return s + n
+}
+
+var i = 0
+var total = 0
+while (i < 6) {
+    let a = sq(i)
+    let b = clamp(a, max: 10)
+    total = total + b
+    i = i + 1
+}
+write(total, "\n")
+let r = sum(4)
+write(r, "\n")
+let o = ord("A")
+write(o, "\n")
@@ -0,0 +1,38 @@
+func scale(_ x : Int, by k : Int) -> Int {
+    var r = x * k - x
+    r = r - x * k
+    r = x * k - r
+    return r
+}
+
+var a = 7
+var b = 3
+var c = a + b
+write(c, "\n")
+c = a * b - c
+write(c, "\n")
+c = c - a * b
+write(c, "\n")
+if a != b {
+    write("differ\n")
+} else {
+    write("same\n")
+}
+var d = Int2Double(a)
+d = d + 0.5
+write(d, "\n")
+d = d / 2.0
+write(d, "\n")
+let s = "hello"
+let n = length(s)
+write(n, "\n")
+let t = s + " world"
+write(t, "\n")
+var i = 0
+while i < n {
+    i = i + 1
+    c = i
+}
+write(i, c, "\n")
+let scaled = scale(5, by: 4)
+write(scaled, "\n")
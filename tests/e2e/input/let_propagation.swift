@@ -0,0 +1,22 @@
+let greeting = "Hi there"
+let limit = 3
+let none : Int? = nil
+let copy = limit
+let copy2 = copy
+
+func show(_ v : Int) {
+    let prefix = greeting
+    write(prefix, " ", v, "\n")
+}
+
+var i = 0
+while (i < copy2) {
+    show(i)
+    i = i + 1
+}
+
+let value = none ?? limit
+write(value, "\n")
+let other = i
+i = i + 10
+write(other, " ", i, "\n")
@@ -0,0 +1,27 @@
+func count(_ n : Int) -> Int {
+    var i = 0
+    var total = 0
+    while (i < n) {
+        var j = 0
+        while (j <= i) {
+            total = total + 1
+            j = j + 1
+        }
+        i = i + 1
+    }
+    return total
+}
+
+var limit : Int? = nil
+var k = 0
+while (k < (limit ?? 4)) {
+    k = k + 1
+}
+write(k, "\n")
+while (k > 100) {
+    write("never\n")
+}
+var t = count(4)
+write(t, "\n")
+var u = count(0)
+write(u, "\n")
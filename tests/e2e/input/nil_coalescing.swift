@@ -0,0 +1,20 @@
+var x : Int? = nil
+var y : Int? = 7
+var z : String? = nil
+var a = x ?? 1
+var b = y ?? 2
+var c = nil ?? 3
+write(a, " ", b, " ", c, "\n")
+var d = x ?? (y ?? 4)
+var e = x ?? 5
+var f = y ?? 5
+write(d, " ", e, " ", f, "\n")
+var s = z ?? "empty"
+write(s, "\n")
+var i = 0
+var sum = 0
+while (i < 3) {
+    sum = sum + (y ?? 0) + (x ?? i)
+    i = i + 1
+}
+write(sum, "\n")
@@ -0,0 +1,59 @@
+let x : Int? = 5
+var y = x ?? 0
+write(y, "\n")
+
+var w : Int? = nil
+y = w ?? 1
+write(y, "\n")
+w = 4
+y = w ?? 1
+write(y, "\n")
+
+let s : String? = readString()
+var t = s ?? "none"
+write(t, "\n")
+if let s {
+    t = s
+} else {
+    t = "still none"
+}
+write(t, "\n")
+
+var v : Int? = nil
+var i = 0
+while i < 3 {
+    y = v ?? 10
+    write(y, " ")
+    v = i
+    i = i + 1
+}
+y = v ?? 20
+write(y, "\n")
+
+var u : Int? = readInt()
+if i > 1 {
+    u = 7
+} else {
+    u = nil
+}
+y = u ?? 30
+write(y, "\n")
+if i > 1 {
+    u = 8
+} else {
+    u = 9
+}
+y = u ?? 40
+write(y, "\n")
+
+func pick(_ a : Int?, _ b : Int) -> Int {
+    var c : Int? = a
+    let first = c ?? b
+    c = b
+    let second = c ?? 0
+    return first + second
+}
+let p = pick(nil, 2)
+write(p, "\n")
+let q = pick(3, 2)
+write(q, "\n")
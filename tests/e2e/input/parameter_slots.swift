@@ -0,0 +1,30 @@
+func repeatText(_ text : String, times n : Int) -> String {
+    var result = ""
+    var i = 0
+    while (i < n) {
+        result = result + text
+        i = i + 1
+    }
+    return result
+}
+
+func shadow(_ x : Int) -> Int {
+    let y = x
+    if (y > 0) {
+        let x = y * 10
+        write(x, " ")
+    } else {
+    }
+    return x
+}
+
+func pass(_ a : Int, _ b : Int) -> Int {
+    let r = shadow(b)
+    let s = shadow(a)
+    return r - s
+}
+
+let t = repeatText("ab", times: 3)
+write(t, "\n")
+let p = pass(2, 7)
+write(p, "\n")
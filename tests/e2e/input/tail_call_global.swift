@@ -0,0 +1,14 @@
+var g = 0
+func f(_ n : Int) -> Int {
+    var result = 0
+    g = g + 1
+    if (n == 0) {
+    } else {
+        let m = n - 1
+        let rest = f(m)
+        result = g + rest
+    }
+    return result
+}
+let r = f(3)
+write(r, " ", g)
@@ -0,0 +1,67 @@
+func countdown(_ n : Int) {
+    if (n > 0) {
+        let m = n - 1
+        countdown(m)
+    } else {
+        write("liftoff\n")
+    }
+}
+
+func sum(_ n : Int) -> Int {
+    var result = 0
+    if (n == 0) {
+    } else {
+        let m = n - 1
+        let rest = sum(m)
+        result = n + rest
+    }
+    return result
+}
+
+func gcd(_ a : Int, _ b : Int) -> Int {
+    var result = a
+    if (a == b) {
+    } else {
+        if (a < b) {
+            result = gcd(b, a)
+        } else {
+            let d = a - b
+            result = gcd(d, b)
+        }
+    }
+    return result
+}
+
+func halve(_ x : Double, _ n : Int) -> Double {
+    var result = x
+    if (n == 0) {
+    } else {
+        let m = n - 1
+        let h = halve(x, m)
+        result = h * 0.5
+    }
+    return result
+}
+
+func fib(_ n : Int) -> Int {
+    var result = n
+    if (n < 2) {
+    } else {
+        let n1 = n - 1
+        let n2 = n - 2
+        let a = fib(n1)
+        let b = fib(n2)
+        result = a + b
+    }
+    return result
+}
+
+countdown(100000)
+let s = sum(100000)
+write(s, "\n")
+let g = gcd(48, 180)
+write(g, "\n")
+let h = halve(8.0, 3)
+write(h, "\n")
+let f = fib(15)
+write(f, "\n")
@@ -0,0 +1,22 @@
+let s = "hello"
+let k = 3
+var i = 0
+var total = 0
+while (i < 5) {
+    let l = length(s)
+    var j = 0
+    while (j < 2) {
+        total = total + k * 2 + l
+        j = j + 1
+    }
+    i = i + 1
+}
+write(total, "\n")
+let d = 2.5
+var x = 0.0
+var n = 0
+while (n < 3) {
+    x = x + d * 2
+    n = n + 1
+}
+write(x, "\n")
@@ -2,6 +2,7 @@
 
 testNum=1
 compilerPath="./ifj23"
+interpreterPath="${IC23INT:-./ic23int}"
 
 execTest () {
 	echo -e "----------------------------------------"
@@ -11,9 +12,9 @@ execTest () {
 	if [ "$returnCode" = "0" ]; then
 		if [ -z "$5" ]
 		then
-			./ic23int tmp.txt > ic23int_output.txt
+			$interpreterPath tmp.txt > ic23int_output.txt
 		else
-			./ic23int tmp.txt < $5 > ic23int_output.txt
+			$interpreterPath tmp.txt < $5 > ic23int_output.txt
 		fi
 	fi
 	printf "\n" >> ic23int_output.txt
@@ -158,3 +159,23 @@ execTest "Read string and ??" "input/readed.swift" "output/readed.txt" 0 "input/
 execTest "Syntax-might-delete-later" "input/syntax.swift" "output/empty.txt" 2
 execTest "Nil as literal" "input/nil_as_literal.swift" "output/empty.txt" 4
 execTest "Type casting" "input/type_casting.swift" "output/type_casting.txt" 0
+execTest "Inlined calls in while loop" "input/inline_call_loop.swift" "output/inline_call_loop.txt" 0
+execTest "Invariant computations in while loops" "input/while_invariant.swift" "output/while_invariant.txt" 0
+execTest "Let constants and copies" "input/let_propagation.swift" "output/let_propagation.txt" 0
+execTest "Common subexpressions" "input/common_subexpressions.swift" "output/common_subexpressions.txt" 0
+execTest "Nil coalescing" "input/nil_coalescing.swift" "output/nil_coalescing.txt" 0
+execTest "Functions after main program" "input/function_layout.swift" "output/function_layout.txt" 0
+execTest "Rotated while loops" "input/loop_rotation.swift" "output/loop_rotation.txt" 0
+execTest "Direct conditional branches" "input/direct_branches.swift" "output/direct_branches.txt" 0
+execTest "Tail calls and linear recursion" "input/tail_calls.swift" "output/tail_calls.txt" 0
+execTest "Frame slots shared by local variables" "input/frame_slots.swift" "output/frame_slots.txt" 0
+execTest "Parameters read from argument slots" "input/parameter_slots.swift" "output/parameter_slots.txt" 0
+execTest "Concatenation chains" "input/concat_chains.swift" "output/concat_chains.txt" 0
+execTest "Placement of implicit conversions" "input/conversion_placement.swift" "output/conversion_placement.txt" 0
+execTest "Inline expansion of ord and substring" "input/builtin_inline.swift" "output/builtin_inline.txt" 0
+execTest "Superinstructions selected from stack sequences" "input/instruction_selection.swift" "output/instruction_selection.txt" 0
+execTest "Nil coalescing of non-nil variables" "input/nil_flow.swift" "output/nil_flow.txt" 0 "input/nil_flow-input.swift"
+execTest "Implicit nil initialization and unread variables" "input/dead_stores.swift" "output/dead_stores.txt" 0
+execTest "Calls of pure functions evaluated at compile time" "input/compile_time_calls.swift" "output/compile_time_calls.txt" 0 "input/compile_time_calls-input.swift"
+execTest "Functions cloned for constant arguments" "input/function_cloning.swift" "output/function_cloning.txt" 0
+execTest "Tail call with global variable changed by recursion" "input/tail_call_global.swift" "output/tail_call_global.txt" 0
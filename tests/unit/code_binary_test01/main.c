@@ -0,0 +1,67 @@
+/**
+ * @name IFJ23
+ * @file main.c
+ * @brief main to encode and decode binary container
+ * @author Marie Kolarikova <xkolar77@stud.fit.vutbr.cz>
+ * @date 3.12.2023
+ **/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "code_binary.h"
+
+/**
+ * encodes program.txt (every kind of operand and constant, repeated names and constants)
+ * and prints sizes of tables and text form decoded from container
+ */
+
+int main() {
+    FILE *source = fopen("program.txt", "r");
+    if (source == NULL) {
+        return 1;
+    }
+
+    code_buffer_t code;
+    code_buffer_init(&code);
+
+    char line[256];
+    while (fgets(line, sizeof(line), source) != NULL) {
+        line[strcspn(line, "\n")] = '\0';
+        if (line[0] == '\0' || line[0] == '.') {
+            continue;
+        }
+        code_buffer_append(&code, instruction_parse(line));
+    }
+    fclose(source);
+
+    FILE *file = tmpfile();
+    if (file == NULL || !code_binary_write(&code, file)) {
+        printf("write failed\n");
+        return 1;
+    }
+
+    unsigned char data[4096];
+    rewind(file);
+    size_t size = fread(data, 1, sizeof(data), file);
+    fclose(file);
+
+    code_binary_t binary;
+    code_buffer_t decoded;
+    code_buffer_init(&decoded);
+    if (!code_binary_open(&binary, data, size) || !code_binary_read(&binary, &decoded)) {
+        printf("read failed\n");
+        return 1;
+    }
+    printf("names %u, constants %u, instructions %u\n", binary.name_count, binary.constant_count, binary.instruction_count);
+    code_buffer_print(&decoded, stdout);
+
+    // truncated container is rejected
+    code_binary_close(&binary);
+    printf("truncated %s\n", code_binary_open(&binary, data, size / 2) ? "accepted" : "rejected");
+    code_binary_close(&binary);
+
+    code_buffer_dispose(&code);
+    code_buffer_dispose(&decoded);
+    return 0;
+}
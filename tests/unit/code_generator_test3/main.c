@@ -58,5 +58,7 @@ int main(int argc, char ** argv) {
     code_generator_function_call_param_add("write", b);
     code_generator_function_call("write");
 
+    code_generator_eof();
+
     return 0;
 }
@@ -95,5 +95,7 @@ int main(int argc, char ** argv) {
     code_generator_function_call_param_add("write", c);
     code_generator_function_call("write");
 
+    code_generator_eof();
+
     return 0;
 }
@@ -0,0 +1,40 @@
+/**
+ * @name IFJ23
+ * @file main.c
+ * @brief main to run interpreter
+ * @author Marie Kolarikova <xkolar77@stud.fit.vutbr.cz>
+ * @date 3.12.2023
+ **/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "interpreter.h"
+
+/**
+ * runs program.txt (while loops nested in function) with profile
+ * and prints report of profile after its output
+ */
+
+int main() {
+    FILE *source = fopen("program.txt", "r");
+    if (source == NULL) {
+        return 1;
+    }
+
+    interpreter_program_t program;
+    interpreter_program_init(&program);
+
+    int result = interpreter_load(&program, source);
+    fclose(source);
+
+    interpreter_profile_t profile;
+    if (result == 0 && interpreter_profile_init(&profile, &program)) {
+        result = interpreter_run(&program, stdin, stdout, false, &profile);
+        interpreter_profile_report(&profile, &program, stdout);
+        interpreter_profile_dispose(&profile);
+    }
+    printf("\n%d\n", result);
+
+    interpreter_program_dispose(&program);
+    return 0;
+}
@@ -0,0 +1,48 @@
+/**
+ * @name IFJ23
+ * @file main.c
+ * @brief main to run interpreter
+ * @author Marie Kolarikova <xkolar77@stud.fit.vutbr.cz>
+ * @date 3.12.2023
+ **/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "interpreter.h"
+
+/**
+ * runs program.txt (function with while loop inlined in while loop) with profile
+ * and prints report of profile including lines of source from map.txt
+ */
+
+int main() {
+    FILE *source = fopen("program.txt", "r");
+    if (source == NULL) {
+        return 1;
+    }
+
+    interpreter_program_t program;
+    interpreter_program_init(&program);
+
+    int result = interpreter_load(&program, source);
+    fclose(source);
+
+    FILE *map = fopen("map.txt", "r");
+    if (result == 0 && map != NULL) {
+        result = interpreter_load_line_map(&program, map);
+    }
+    if (map != NULL) {
+        fclose(map);
+    }
+
+    interpreter_profile_t profile;
+    if (result == 0 && interpreter_profile_init(&profile, &program)) {
+        result = interpreter_run(&program, stdin, stdout, false, &profile);
+        interpreter_profile_report(&profile, &program, stdout);
+        interpreter_profile_dispose(&profile);
+    }
+    printf("\n%d\n", result);
+
+    interpreter_program_dispose(&program);
+    return 0;
+}
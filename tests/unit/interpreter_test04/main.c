@@ -0,0 +1,37 @@
+/**
+ * @name IFJ23
+ * @file main.c
+ * @brief main to run interpreter
+ * @author Marie Kolarikova <xkolar77@stud.fit.vutbr.cz>
+ * @date 3.12.2023
+ **/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "interpreter.h"
+
+/**
+ * runs program.txt (lower case and mixed case names of instructions)
+ * and prints its exit code after its output
+ */
+
+int main() {
+    FILE *source = fopen("program.txt", "r");
+    if (source == NULL) {
+        return 1;
+    }
+
+    interpreter_program_t program;
+    interpreter_program_init(&program);
+
+    int result = interpreter_load(&program, source);
+    fclose(source);
+
+    if (result == 0) {
+        result = interpreter_run(&program, stdin, stdout, false, NULL);
+    }
+    printf("\n%d\n", result);
+
+    interpreter_program_dispose(&program);
+    return 0;
+}
@@ -0,0 +1,23 @@
+/**
+ * @file main.c
+ * @author Marie Kolarikova (xkolar77@stud.fit.vutbr.cz)
+ * @brief prints tokens with their positions in source code
+ * @date 2023-12-03
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "lexical_analyzer.h"
+
+int main() {
+    
+    token_T token;
+
+    do {
+        if (get_token(&token)) return 1;
+        print_token(token);
+        printf(" %u:%u-%u:%u\n", token.span.line, token.span.column, token.span.end_line, token.span.end_column);
+    } while (token.type != TOKEN_EOF);
+    
+    return 0;
+}